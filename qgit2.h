@@ -28,10 +28,12 @@
 #define LIBQGIT2_SOVERSION 1
 
 #include "qgit2/qgitblob.h"
+#include "qgit2/qgitchangehintprovider.h"
 #include "qgit2/qgitcheckoutoptions.h"
 #include "qgit2/qgitcherrypickoptions.h"
 #include "qgit2/qgitcommit.h"
 #include "qgit2/qgitconfig.h"
+#include "qgit2/qgitconflictiterator.h"
 #include "qgit2/qgitcredentials.h"
 #include "qgit2/qgitdatabase.h"
 #include "qgit2/qgitdatabasebackend.h"
@@ -43,20 +45,27 @@
 #include "qgit2/qgitindex.h"
 #include "qgit2/qgitindexentry.h"
 #include "qgit2/qgitindexmodel.h"
+#include "qgit2/qgitlistiterator.h"
 #include "qgit2/qgitmergeoptions.h"
 #include "qgit2/qgitobject.h"
 #include "qgit2/qgitoid.h"
 #include "qgit2/qgitref.h"
+#include "qgit2/qgitreferenceiterator.h"
+#include "qgit2/qgitreftransaction.h"
 #include "qgit2/qgitremote.h"
 #include "qgit2/qgitrepository.h"
+#include "qgit2/qgitrepositorypool.h"
 #include "qgit2/qgitrevwalk.h"
 #include "qgit2/qgitsignature.h"
+#include "qgit2/qgitstatcache.h"
 #include "qgit2/qgitstatus.h"
 #include "qgit2/qgitstatusentry.h"
 #include "qgit2/qgitstatuslist.h"
 #include "qgit2/qgitstatusoptions.h"
 #include "qgit2/qgittag.h"
 #include "qgit2/qgittree.h"
+#include "qgit2/qgittreebuilder.h"
 #include "qgit2/qgittreeentry.h"
+#include "qgit2/qgitworkdirwatcher.h"
 
 #endif
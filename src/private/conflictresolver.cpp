@@ -0,0 +1,147 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "conflictresolver.h"
+
+#include "qgitexception.h"
+#include "qgitoid.h"
+#include "private/pathcodec.h"
+
+#include "git2/sys/index.h"
+
+#include <QByteArray>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <string.h>
+
+namespace LibQGit2 {
+namespace internal {
+
+namespace {
+
+struct Resolution {
+    QByteArray path;
+    OId id;
+    unsigned int modes[3];
+    git_oid ids[3];
+};
+
+struct NameEntry {
+    QByteArray ancestor;
+    QByteArray ours;
+    QByteArray theirs;
+};
+
+const char *nullable(const QByteArray &path)
+{
+    return path.isNull() ? NULL : path.constData();
+}
+
+}
+
+void resolveConflicts(git_index *index, git_repository *repo, const QMap<QString, OId> &resolutions)
+{
+    if (!repo) {
+        throw Exception("Index::resolveConflicts(): the index has no repository to find the blobs in");
+    }
+    git_odb *odb = 0;
+    qGitThrow(git_repository_odb(&odb, repo));
+    QSharedPointer<git_odb> odbRef(odb, git_odb_free);
+
+    // everything is checked before the index is changed
+    QVector<Resolution> resolved;
+    resolved.reserve(resolutions.size());
+    QSet<QByteArray> resolvedPaths;
+    for (QMap<QString, OId>::const_iterator it = resolutions.constBegin(); it != resolutions.constEnd(); ++it) {
+        Resolution resolution;
+        resolution.path = PathCodec::toLibGit2(it.key());
+        resolution.id = it.value();
+
+        const git_index_entry *stages[3];
+        const int error = git_index_conflict_get(&stages[0], &stages[1], &stages[2], index, resolution.path);
+        if (error == GIT_ENOTFOUND) {
+            giterr_clear();
+            throw Exception("Index::resolveConflicts(): no conflict for " + it.key());
+        }
+        qGitThrow(error);
+
+        for (int stage = 0; stage < 3; ++stage) {
+            resolution.modes[stage] = stages[stage] ? stages[stage]->mode : 0;
+            if (stages[stage]) {
+                git_oid_cpy(&resolution.ids[stage], &stages[stage]->id);
+            } else {
+                memset(&resolution.ids[stage], 0, sizeof(git_oid));
+            }
+        }
+
+        if (resolution.id.isValid() && !git_odb_exists(odb, resolution.id.constData())) {
+            throw Exception(QString("Index::resolveConflicts(): no blob %1 for %2")
+                            .arg(QString::fromLatin1(resolution.id.format()), it.key()));
+        }
+
+        resolved.append(resolution);
+        resolvedPaths.insert(resolution.path);
+    }
+
+    foreach (const Resolution &resolution, resolved) {
+        qGitThrow(git_index_conflict_remove(index, resolution.path));
+
+        if (resolution.id.isValid()) {
+            // keep the mode of our side if it has one
+            const unsigned int *modes = resolution.modes;
+            git_index_entry entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.path = resolution.path.constData();
+            entry.mode = modes[1] ? modes[1] : modes[2] ? modes[2] : modes[0];
+            git_oid_cpy(&entry.id, resolution.id.constData());
+            qGitThrow(git_index_add(index, &entry));
+        }
+
+        qGitThrow(git_index_reuc_add(index, resolution.path,
+                                     resolution.modes[0], &resolution.ids[0],
+                                     resolution.modes[1], &resolution.ids[1],
+                                     resolution.modes[2], &resolution.ids[2]));
+    }
+
+    // name entries can only be cleared all at once, so keep the other ones
+    QVector<NameEntry> names;
+    bool namesResolved = false;
+    for (size_t i = 0; i < git_index_name_entrycount(index); ++i) {
+        const git_index_name_entry *entry = git_index_name_get_byindex(index, i);
+        NameEntry copy;
+        copy.ancestor = entry->ancestor ? QByteArray(entry->ancestor) : QByteArray();
+        copy.ours = entry->ours ? QByteArray(entry->ours) : QByteArray();
+        copy.theirs = entry->theirs ? QByteArray(entry->theirs) : QByteArray();
+        if (resolvedPaths.contains(copy.ancestor) || resolvedPaths.contains(copy.ours) || resolvedPaths.contains(copy.theirs)) {
+            namesResolved = true;
+        } else {
+            names.append(copy);
+        }
+    }
+    if (namesResolved) {
+        git_index_name_clear(index);
+        foreach (const NameEntry &entry, names) {
+            qGitThrow(git_index_name_add(index, nullable(entry.ancestor), nullable(entry.ours), nullable(entry.theirs)));
+        }
+    }
+}
+
+}
+}
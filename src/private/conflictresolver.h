@@ -0,0 +1,52 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_CONFLICTRESOLVER_H
+#define LIBQGIT2_CONFLICTRESOLVER_H
+
+#include "git2.h"
+
+#include <QMap>
+#include <QString>
+
+namespace LibQGit2 {
+
+class OId;
+
+namespace internal {
+
+/**
+ * Replaces the conflicts of \a index for the paths of \a resolutions with stage 0
+ * entries for the given blobs, or removes the paths if the blob id is invalid.
+ *
+ * All the resolutions are checked first: each path must be conflicted and each
+ * valid blob id must exist in the object database of \a repo, which is required.
+ * Only then are the conflicts replaced, one path at a time, so the other entries of
+ * the index and its tree cache are left alone. As git does, the stages of each
+ * resolved conflict are recorded as a resolve undo entry; the name entries of the
+ * resolved paths are dropped.
+ *
+ * @throws LibQGit2::Exception if \a repo is null, a path has no conflict or a blob
+ *         is missing, in which case \a index is left untouched
+ */
+void resolveConflicts(git_index *index, git_repository *repo, const QMap<QString, OId> &resolutions);
+
+}
+}
+
+#endif // LIBQGIT2_CONFLICTRESOLVER_H
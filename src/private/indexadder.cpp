@@ -0,0 +1,280 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "indexadder.h"
+
+#include "qgitexception.h"
+#include "private/parallel.h"
+#include "private/pathcodec.h"
+#include "private/strarray.h"
+#include "private/workdirfile.h"
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <algorithm>
+#include <string.h>
+
+namespace LibQGit2 {
+namespace internal {
+
+namespace {
+
+QList<QByteArray> encodePaths(const QStringList &paths)
+{
+    QList<QByteArray> encoded;
+    foreach (const QString &path, paths) {
+        encoded.append(PathCodec::toLibGit2(path));
+    }
+    return encoded;
+}
+
+#ifdef Q_OS_UNIX
+
+// files are read a chunk of at most this many bytes at a time...
+const qint64 ChunkBytes = 64 * 1024 * 1024;
+// ...and files larger than this are streamed into the object database instead
+const quint32 MaxBufferedSize = 4 * 1024 * 1024;
+
+enum State {
+    Pending,
+    Filtered,       // hashed and written by libgit2, from the calling thread
+    Hashed,
+    Missing,
+    Other           // directories, conflicts: left to git_index_add_bypath()
+};
+
+struct Item {
+    QByteArray path;
+    quint32 indexedMode;
+    bool conflicted;
+    State state;
+    bool buffered;
+    WorkdirFile file;
+    git_oid id;
+    QByteArray content;
+};
+
+#endif
+
+}
+
+IndexAdder::IndexAdder(git_index *index, int threads)
+    : m_index(index),
+      m_repo(git_index_owner(index)),
+      m_threads(threads)
+{
+    if (!m_repo || git_repository_is_bare(m_repo)) {
+        throw Exception("Index: the index has no working directory to add files from");
+    }
+}
+
+void IndexAdder::add(const QStringList &paths)
+{
+    add(encodePaths(paths), false);
+}
+
+#ifndef Q_OS_UNIX
+
+void IndexAdder::addAll(const QStringList &pathspec)
+{
+    // no parallel implementation, let libgit2 do it
+    StrArray paths(encodePaths(pathspec));
+    qGitThrow(git_index_add_all(m_index, &paths.data(), GIT_INDEX_ADD_DEFAULT, NULL, NULL));
+}
+
+void IndexAdder::add(const QList<QByteArray> &paths, bool)
+{
+    foreach (const QByteArray &path, paths) {
+        qGitThrow(git_index_add_bypath(m_index, path));
+    }
+}
+
+#else
+
+void IndexAdder::addAll(const QStringList &pathspec)
+{
+    StrArray paths(encodePaths(pathspec));
+    git_diff_options opts = GIT_DIFF_OPTIONS_INIT;
+    opts.flags = GIT_DIFF_INCLUDE_UNTRACKED | GIT_DIFF_RECURSE_UNTRACKED_DIRS | GIT_DIFF_INCLUDE_TYPECHANGE;
+    opts.pathspec = paths.data();
+
+    git_diff *diff = 0;
+    qGitThrow(git_diff_index_to_workdir(&diff, m_repo, m_index, &opts));
+    QSharedPointer<git_diff> guard(diff, git_diff_free);
+
+    QList<QByteArray> added, removed;
+    const size_t count = git_diff_num_deltas(diff);
+    for (size_t i = 0; i < count; ++i) {
+        const git_diff_delta *delta = git_diff_get_delta(diff, i);
+        switch (delta->status) {
+        case GIT_DELTA_UNTRACKED:
+        case GIT_DELTA_MODIFIED:
+        case GIT_DELTA_TYPECHANGE:
+        case GIT_DELTA_CONFLICTED:
+            added.append(QByteArray(delta->new_file.path));
+            break;
+        case GIT_DELTA_DELETED:
+            removed.append(QByteArray(delta->old_file.path));
+            break;
+        default:
+            break;
+        }
+    }
+
+    add(added, true);
+    foreach (const QByteArray &path, removed) {
+        qGitThrow(git_index_remove_bypath(m_index, path));
+    }
+}
+
+void IndexAdder::add(const QList<QByteArray> &paths, bool removeMissing)
+{
+    QList<QByteArray> sorted(paths);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    const QByteArray workdir(git_repository_workdir(m_repo));
+    const bool trustMode = trustFileMode(m_repo);
+    const bool hasConflicts = git_index_has_conflicts(m_index);
+
+    QVector<Item> items(sorted.size());
+    for (int i = 0; i < sorted.size(); ++i) {
+        Item &item = items[i];
+        item.path = sorted[i];
+        const git_index_entry *existing = git_index_get_bypath(m_index, item.path, 0);
+        item.indexedMode = existing ? existing->mode : 0;
+        item.conflicted = false;
+        if (hasConflicts) {
+            const git_index_entry *ancestor, *ours, *theirs;
+            const int error = git_index_conflict_get(&ancestor, &ours, &theirs, m_index, item.path);
+            if (error == GIT_ENOTFOUND) {
+                giterr_clear();
+            } else {
+                qGitThrow(error);
+                item.conflicted = true;
+            }
+        }
+        item.state = !item.conflicted && hasFilters(m_repo, item.path) ? Filtered : Pending;
+        item.buffered = false;
+    }
+
+    // a gone file, a directory or a conflict is handled by libgit2 alone
+    parallelFor(items.size(), m_threads, [&](int begin, int end) {
+        QByteArray path(workdir);
+        for (int i = begin; i < end; ++i) {
+            Item &item = items[i];
+            path.resize(workdir.size());
+            path.append(item.path);
+            if (!item.file.stat(path.constData(), trustMode, item.indexedMode)) {
+                item.state = Missing;
+            } else if (item.file.mode == 0 || item.conflicted) {
+                item.state = Other;
+            }
+        }
+    });
+
+    git_odb *odbPtr = 0;
+    qGitThrow(git_repository_odb(&odbPtr, m_repo));
+    QSharedPointer<git_odb> odb(odbPtr, git_odb_free);
+
+    for (int begin = 0; begin < items.size(); ) {
+        int end = begin;
+        qint64 bytes = 0;
+        while (end < items.size() && bytes < ChunkBytes) {
+            const Item &item = items[end++];
+            if (item.state == Pending && item.file.size <= MaxBufferedSize) {
+                bytes += item.file.size;
+            }
+        }
+
+        // read and hash the unfiltered files of this chunk...
+        parallelFor(end - begin, m_threads, [&](int first, int last) {
+            QByteArray path(workdir);
+            for (int i = begin + first; i < begin + last; ++i) {
+                Item &item = items[i];
+                if (item.state != Pending) {
+                    continue;
+                }
+                path.resize(workdir.size());
+                path.append(item.path);
+                if (item.file.mode == GIT_FILEMODE_LINK || item.file.size <= MaxBufferedSize) {
+                    item.content = item.file.read(path.constData());
+                    item.buffered = true;
+                    qGitThrow(git_odb_hash(&item.id, item.content.constData(), size_t(item.content.size()), GIT_OBJ_BLOB));
+                } else {
+                    item.file.hash(path.constData(), &item.id);
+                }
+                item.state = Hashed;
+            }
+        });
+
+        // ...and write the blobs that are not in the object database yet
+        for (int i = begin; i < end; ++i) {
+            Item &item = items[i];
+            if (item.state == Filtered) {
+                qGitThrow(git_blob_create_fromworkdir(&item.id, m_repo, item.path));
+                item.state = Hashed;
+            } else if (item.state == Hashed && !git_odb_exists(odb.data(), &item.id)) {
+                if (item.buffered) {
+                    git_oid written;
+                    qGitThrow(git_odb_write(&written, odb.data(), item.content.constData(), size_t(item.content.size()), GIT_OBJ_BLOB));
+                } else {
+                    qGitThrow(git_blob_create_fromworkdir(&item.id, m_repo, item.path));
+                }
+            }
+            item.content = QByteArray();
+        }
+        begin = end;
+    }
+
+    QVector<git_index_entry> entries;
+    QList<QByteArray> others, removed;
+    foreach (const Item &item, items) {
+        if (item.state == Hashed) {
+            git_index_entry entry;
+            memset(&entry, 0, sizeof(entry));
+            item.file.copyTo(entry);
+            entry.path = item.path.constData();
+            git_oid_cpy(&entry.id, &item.id);
+            entries.append(entry);
+        } else if (item.state == Missing && removeMissing) {
+            removed.append(item.path);
+        } else {
+            others.append(item.path);
+        }
+    }
+
+    // in path order, git_index_add() also replaces the entries of parent directories
+    // and of files below a path, and only invalidates the tree cache along each path
+    foreach (const git_index_entry &entry, entries) {
+        qGitThrow(git_index_add(m_index, &entry));
+    }
+    foreach (const QByteArray &path, others) {
+        qGitThrow(git_index_add_bypath(m_index, path));
+    }
+    foreach (const QByteArray &path, removed) {
+        qGitThrow(git_index_remove_bypath(m_index, path));
+    }
+}
+
+#endif
+
+}
+}
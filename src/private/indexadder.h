@@ -0,0 +1,73 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_INDEXADDER_H
+#define LIBQGIT2_INDEXADDER_H
+
+#include "git2.h"
+
+#include <QStringList>
+
+namespace LibQGit2 {
+namespace internal {
+
+/**
+ * Adds many files of the working directory to an index at once, like repeated
+ * calls to git_index_add_bypath().
+ *
+ * The files are lstat'ed and, unless a filter applies to them, read and hashed
+ * from several threads, a chunk at a time. The blobs missing from the object
+ * database are then written from the calling thread, and the entries are inserted
+ * one git_index_add() at a time, in path order.
+ */
+class IndexAdder
+{
+public:
+    IndexAdder(git_index *index, int threads);
+
+    IndexAdder(const IndexAdder &other) = delete;
+    IndexAdder &operator=(const IndexAdder &rhs) = delete;
+
+    /**
+     * Adds or updates the entries for the files at \a paths, relative to the working
+     * directory.
+     *
+     * @throws LibQGit2::Exception
+     */
+    void add(const QStringList &paths);
+
+    /**
+     * Adds the untracked and modified files matching \a pathspec, or all of them if
+     * it is empty, and removes the entries of deleted files. Ignored files are skipped.
+     *
+     * @throws LibQGit2::Exception
+     */
+    void addAll(const QStringList &pathspec);
+
+private:
+    void add(const QList<QByteArray> &paths, bool removeMissing);
+
+    git_index *m_index;
+    git_repository *m_repo;
+    int m_threads;
+};
+
+}
+}
+
+#endif // LIBQGIT2_INDEXADDER_H
@@ -0,0 +1,256 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "indexrefresher.h"
+
+#include "qgitexception.h"
+#include "private/parallel.h"
+#include "private/pathcodec.h"
+#include "private/strarray.h"
+#include "private/workdirfile.h"
+
+#include <QByteArray>
+#include <QVector>
+
+#include <limits>
+
+namespace LibQGit2 {
+namespace internal {
+
+namespace {
+
+StrArray encodePaths(const QStringList &paths)
+{
+    QList<QByteArray> encoded;
+    foreach (const QString &path, paths) {
+        encoded.append(PathCodec::toLibGit2(path));
+    }
+    return StrArray(encoded);
+}
+
+#ifndef Q_OS_UNIX
+
+int collectPath(const char *path, const char *, void *payload)
+{
+    static_cast<QStringList*>(payload)->append(PathCodec::fromLibGit2(path));
+    return 0;
+}
+
+#else
+
+enum State {
+    Unchanged,
+    Skipped,        // gitlinks
+    NeedsHash,
+    NeedsFilteredHash,
+    Hashed,
+    Removed
+};
+
+struct Candidate {
+    const git_index_entry *entry;
+    State state;
+    WorkdirFile file;
+    git_oid id;
+};
+
+#endif
+
+}
+
+IndexRefresher::IndexRefresher(git_index *index, int threads)
+    : m_index(index),
+      m_repo(git_index_owner(index)),
+      m_threads(threads)
+{
+    if (!m_repo || git_repository_is_bare(m_repo)) {
+        throw Exception("Index::refresh(): the index has no working directory");
+    }
+}
+
+QStringList IndexRefresher::refresh(const QStringList &pathspec)
+{
+    return run(pathspec, false);
+}
+
+void IndexRefresher::refreshStatData(const QStringList &pathspec)
+{
+    run(pathspec, true);
+}
+
+#ifndef Q_OS_UNIX
+
+QStringList IndexRefresher::run(const QStringList &pathspec, bool statOnly)
+{
+    // git_index_update_all() would stage the changes
+    if (statOnly) {
+        return QStringList();
+    }
+
+    // no parallel stat implementation, let libgit2 do it
+    QStringList changed;
+    StrArray paths = encodePaths(pathspec);
+    qGitThrow(git_index_update_all(m_index, pathspec.isEmpty() ? NULL : &paths.data(), collectPath, &changed));
+    return changed;
+}
+
+#else
+
+QStringList IndexRefresher::run(const QStringList &pathspec, bool statOnly)
+{
+    const QByteArray workdir(git_repository_workdir(m_repo));
+    const bool trustMode = trustFileMode(m_repo);
+
+    // racily clean entries have to be hashed; for an in-memory index all of them are
+    git_index_time indexTime;
+    WorkdirFile indexFile;
+    const char *indexPath = git_index_path(m_index);
+    if (indexPath && indexFile.stat(indexPath, true)) {
+        indexTime = indexFile.mtime;
+    } else {
+        indexTime.seconds = std::numeric_limits<qint32>::min();
+        indexTime.nanoseconds = 0;
+    }
+
+    git_pathspec *ps = 0;
+    if (!pathspec.isEmpty()) {
+        StrArray paths = encodePaths(pathspec);
+        qGitThrow(git_pathspec_new(&ps, &paths.data()));
+    }
+
+    QVector<Candidate> candidates;
+    const size_t count = git_index_entrycount(m_index);
+    candidates.reserve(int(count));
+    for (size_t i = 0; i < count; ++i) {
+        const git_index_entry *entry = git_index_get_byindex(m_index, i);
+        if (git_index_entry_stage(entry) != 0 || (ps && !git_pathspec_matches_path(ps, GIT_PATHSPEC_DEFAULT, entry->path))) {
+            continue;
+        }
+        Candidate candidate;
+        candidate.entry = entry;
+        candidate.state = entry->mode == GIT_FILEMODE_COMMIT ? Skipped : Unchanged;
+        candidates.append(candidate);
+    }
+    git_pathspec_free(ps);
+
+    // first pass: compare the stat data, hashing symbolic links right away
+    parallelFor(candidates.size(), m_threads, [&](int begin, int end) {
+        QByteArray path(workdir);
+        for (int i = begin; i < end; ++i) {
+            Candidate &c = candidates[i];
+            if (c.state == Skipped) {
+                continue;
+            }
+
+            path.resize(workdir.size());
+            path.append(c.entry->path);
+
+            // a directory may have replaced the file, too
+            if (!c.file.stat(path.constData(), trustMode, c.entry->mode) || c.file.mode == 0) {
+                c.state = Removed;
+                continue;
+            }
+
+            if (c.file.matches(c.entry) && !WorkdirFile::isRacy(c.entry->mtime, indexTime)) {
+                continue;
+            }
+
+            if (c.file.mode == GIT_FILEMODE_LINK) {
+                c.file.hash(path.constData(), &c.id);
+                c.state = Hashed;
+            } else {
+                c.state = NeedsHash;
+            }
+        }
+    });
+
+    // filters depend on the attributes, which can only be read from this thread
+    for (int i = 0; i < candidates.size(); ++i) {
+        Candidate &c = candidates[i];
+        if (c.state == NeedsHash && hasFilters(m_repo, c.entry->path)) {
+            c.state = NeedsFilteredHash;
+        }
+    }
+
+    // second pass: hash the unfiltered files
+    parallelFor(candidates.size(), m_threads, [&](int begin, int end) {
+        QByteArray path(workdir);
+        for (int i = begin; i < end; ++i) {
+            Candidate &c = candidates[i];
+            if (c.state != NeedsHash) {
+                continue;
+            }
+            path.resize(workdir.size());
+            path.append(c.entry->path);
+            c.file.hash(path.constData(), &c.id);
+            c.state = Hashed;
+        }
+    });
+
+    QStringList changed;
+    QList<QByteArray> removed;
+    for (int i = 0; i < candidates.size(); ++i) {
+        Candidate &c = candidates[i];
+        const git_index_entry *entry = c.entry;
+
+        if (c.state == NeedsFilteredHash) {
+            const QByteArray path = workdir + entry->path;
+            qGitThrow(git_repository_hashfile(&c.id, m_repo, path.constData(), GIT_OBJ_BLOB, entry->path));
+            c.state = Hashed;
+        }
+
+        if (c.state == Removed) {
+            if (!statOnly) {
+                removed.append(QByteArray(entry->path));
+            }
+            continue;
+        }
+        if (c.state != Hashed) {
+            continue;
+        }
+
+        const bool contentChanged = !git_oid_equal(&c.id, &entry->id);
+        if (statOnly && (contentChanged || c.file.mode != entry->mode)) {
+            continue;
+        }
+        if (contentChanged) {
+            // store the blob, with the filters applied as for the hash
+            qGitThrow(git_blob_create_fromworkdir(&c.id, m_repo, entry->path));
+        }
+        if (contentChanged || c.file.mode != entry->mode) {
+            changed.append(PathCodec::fromLibGit2(entry->path));
+        }
+
+        git_index_entry updated = *entry;
+        c.file.copyTo(updated);
+        git_oid_cpy(&updated.id, &c.id);
+        qGitThrow(git_index_add(m_index, &updated));
+    }
+
+    foreach (const QByteArray &path, removed) {
+        qGitThrow(git_index_remove(m_index, path, 0));
+        changed.append(PathCodec::fromLibGit2(path));
+    }
+
+    return changed;
+}
+
+#endif
+
+}
+}
@@ -0,0 +1,78 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_INDEXREFRESHER_H
+#define LIBQGIT2_INDEXREFRESHER_H
+
+#include "git2.h"
+
+#include <QStringList>
+
+namespace LibQGit2 {
+namespace internal {
+
+/**
+ * Brings the stage 0 entries of an index up to date with the working directory,
+ * like git_index_update_all(), but stats and hashes the files from several threads.
+ *
+ * The files are first lstat'ed in parallel and compared with the stat data cached
+ * in the index. Only the files whose stat data differs, or that are racily clean
+ * (modified in the same second the index was written), are hashed: in parallel
+ * when no filter applies to them, otherwise from the calling thread. All the
+ * changes are then applied to the index from the calling thread.
+ */
+class IndexRefresher
+{
+public:
+    IndexRefresher(git_index *index, int threads);
+
+    IndexRefresher(const IndexRefresher &other) = delete;
+    IndexRefresher &operator=(const IndexRefresher &rhs) = delete;
+
+    /**
+     * Refreshes the entries matching \a pathspec, or all of them if it is empty.
+     *
+     * @return the paths whose content or mode changed or that were removed
+     * @throws LibQGit2::Exception
+     */
+    QStringList refresh(const QStringList &pathspec);
+
+    /**
+     * Updates only the cached stat data of the entries matching \a pathspec, or of all
+     * of them if it is empty, leaving the entries whose content or mode changed, or
+     * whose file was removed, as they are. Nothing gets staged this way.
+     *
+     * Does nothing on platforms without a parallel stat implementation.
+     *
+     * @throws LibQGit2::Exception
+     */
+    void refreshStatData(const QStringList &pathspec);
+
+private:
+    QStringList run(const QStringList &pathspec, bool statOnly);
+
+
+    git_index *m_index;
+    git_repository *m_repo;
+    int m_threads;
+};
+
+}
+}
+
+#endif // LIBQGIT2_INDEXREFRESHER_H
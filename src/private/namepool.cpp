@@ -0,0 +1,93 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "namepool.h"
+
+#include <QMutex>
+#include <QSet>
+
+namespace LibQGit2 {
+namespace internal {
+
+namespace {
+
+struct NamePool {
+    NamePool() : sweepAt(MinSweepSize) {}
+
+    void sweep()
+    {
+        // a detached name is only referred to by the pool itself
+        QSet<QByteArray>::iterator it = names.begin();
+        while (it != names.end()) {
+            if (it->isDetached()) {
+                it = names.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        sweepAt = qMax<int>(MinSweepSize, 2 * names.size());
+    }
+
+    enum { MinSweepSize = 1024 };
+
+    QMutex mutex;
+    QSet<QByteArray> names;
+    int sweepAt;
+};
+
+Q_GLOBAL_STATIC(NamePool, namePool)
+
+}
+
+NameInterner::NameInterner()
+{
+    namePool()->mutex.lock();
+}
+
+NameInterner::~NameInterner()
+{
+    NamePool *pool = namePool();
+    if (pool->names.size() >= pool->sweepAt) {
+        pool->sweep();
+    }
+    pool->mutex.unlock();
+}
+
+QByteArray NameInterner::intern(const char *name)
+{
+    const QByteArray key = QByteArray::fromRawData(name, qstrlen(name));
+
+    NamePool *pool = namePool();
+    QSet<QByteArray>::const_iterator it = pool->names.constFind(key);
+    if (it != pool->names.constEnd()) {
+        return *it;
+    }
+
+    // key refers to memory owned by libgit2, keep a deep copy
+    const QByteArray interned(name);
+    pool->names.insert(interned);
+    return interned;
+}
+
+QByteArray internName(const char *name)
+{
+    return NameInterner().intern(name);
+}
+
+}
+}
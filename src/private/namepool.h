@@ -0,0 +1,61 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_NAMEPOOL_H
+#define LIBQGIT2_NAMEPOOL_H
+
+#include <QByteArray>
+
+namespace LibQGit2 {
+namespace internal {
+
+/**
+ * Interns names in the process-wide name pool while it is locked, so that values
+ * holding many repeated names, such as TreeEntryInfo, only store each distinct name
+ * once. The pool is locked for the lifetime of the object, which lets a whole batch
+ * of names be interned under a single lock.
+ *
+ * The pool is reference counted through the names themselves: a name only held by
+ * the pool is dropped by the next sweep, which runs whenever the pool has doubled in
+ * size since the previous one.
+ */
+class NameInterner
+{
+public:
+    NameInterner();
+    ~NameInterner();
+
+    NameInterner(const NameInterner &other) = delete;
+    NameInterner &operator=(const NameInterner &rhs) = delete;
+
+    /**
+     * Returns a copy of \a name that shares its data with all the equal names
+     * interned before.
+     */
+    QByteArray intern(const char *name);
+};
+
+/**
+ * Interns a single \a name.
+ */
+QByteArray internName(const char *name);
+
+}
+}
+
+#endif // LIBQGIT2_NAMEPOOL_H
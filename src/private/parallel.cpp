@@ -0,0 +1,143 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "parallel.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+#include <exception>
+
+namespace LibQGit2 {
+namespace internal {
+
+namespace {
+
+// small enough to balance the load, large enough to keep the counter cold
+const int MinChunkSize = 256;
+
+struct Work {
+    Work(int count, int chunkSize, const std::function<void (int, int)> &fn)
+        : count(count),
+          chunkSize(chunkSize),
+          fn(fn),
+          next(0),
+          failed(0)
+    {
+    }
+
+    void run()
+    {
+        forever {
+            if (failed.loadAcquire()) {
+                return;
+            }
+
+            const int begin = next.fetchAndAddRelaxed(chunkSize);
+            if (begin >= count) {
+                return;
+            }
+
+            try {
+                fn(begin, qMin(count, begin + chunkSize));
+            } catch (...) {
+                QMutexLocker lock(&mutex);
+                if (!exception) {
+                    exception = std::current_exception();
+                }
+                failed.storeRelease(1);
+            }
+        }
+    }
+
+    const int count;
+    const int chunkSize;
+    const std::function<void (int, int)> &fn;
+    QAtomicInt next;
+    QAtomicInt failed;
+    QMutex mutex;
+    std::exception_ptr exception;
+};
+
+class Worker : public QRunnable
+{
+public:
+    Worker(Work &work, QSemaphore &done)
+        : m_work(work),
+          m_done(done)
+    {
+        setAutoDelete(true);
+    }
+
+    void run()
+    {
+        m_work.run();
+        m_done.release();
+    }
+
+private:
+    Work &m_work;
+    QSemaphore &m_done;
+};
+
+}
+
+void parallelFor(int count, int threads, const std::function<void (int begin, int end)> &fn)
+{
+    if (count <= 0) {
+        return;
+    }
+    if (threads <= 0) {
+        threads = QThread::idealThreadCount();
+    }
+
+    const int chunkSize = qMax(MinChunkSize, count / (threads * 8) + 1);
+    threads = qMin(threads, (count + chunkSize - 1) / chunkSize);
+    if (threads <= 1) {
+        fn(0, count);
+        return;
+    }
+
+    Work work(count, chunkSize, fn);
+    QSemaphore done;
+    int started = 0;
+    for (int i = 1; i < threads; ++i) {
+        Worker *worker = new Worker(work, done);
+        // the calling thread works too, so there is no point in queueing behind other jobs
+        if (!QThreadPool::globalInstance()->tryStart(worker)) {
+            delete worker;
+            break;
+        }
+        ++started;
+    }
+
+    work.run();
+    done.acquire(started);
+
+    if (work.exception) {
+        std::rethrow_exception(work.exception);
+    }
+}
+
+}
+}
@@ -0,0 +1,42 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_PARALLEL_H
+#define LIBQGIT2_PARALLEL_H
+
+#include <functional>
+
+namespace LibQGit2 {
+namespace internal {
+
+/**
+ * Calls \a fn on consecutive ranges [begin, end) covering [0, count), using the
+ * calling thread and up to \a threads - 1 threads of the global QThreadPool, and
+ * returns once all the ranges have been processed.
+ *
+ * \a fn must be safe to call concurrently for different ranges. If it throws, the
+ * remaining ranges are skipped and the first exception is rethrown here.
+ *
+ * If \a threads is not positive, QThread::idealThreadCount() is used.
+ */
+void parallelFor(int count, int threads, const std::function<void (int begin, int end)> &fn);
+
+}
+}
+
+#endif // LIBQGIT2_PARALLEL_H
@@ -0,0 +1,596 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "patchapplier.h"
+
+#include "qgitexception.h"
+#include "private/pathcodec.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <cstring>
+
+namespace LibQGit2 {
+namespace internal {
+
+namespace {
+
+// the largest postimage taken from binary patch data, whose sizes are not trusted;
+// well below the limit of a QByteArray
+const size_t MaxBinarySize = 1024 * 1024 * 1024;
+
+struct Line {
+    int offset;
+    int length;
+};
+
+QVector<Line> splitLines(const QByteArray &content)
+{
+    QVector<Line> lines;
+    int start = 0;
+    while (start < content.size()) {
+        int end = content.indexOf('\n', start);
+        end = (end < 0) ? content.size() : end + 1;
+        const Line line = { start, end - start };
+        lines.append(line);
+        start = end;
+    }
+    return lines;
+}
+
+bool isPreimageLine(const git_diff_line *line)
+{
+    return line->origin == GIT_DIFF_LINE_CONTEXT || line->origin == GIT_DIFF_LINE_DELETION;
+}
+
+bool isPostimageLine(const git_diff_line *line)
+{
+    return line->origin == GIT_DIFF_LINE_CONTEXT || line->origin == GIT_DIFF_LINE_ADDITION;
+}
+
+bool hunkMatches(const QByteArray &preimage, const QVector<Line> &lines, int pos, const QVector<const git_diff_line*> &hunkLines)
+{
+    foreach (const git_diff_line *line, hunkLines) {
+        if (!isPreimageLine(line)) {
+            continue;
+        }
+        const Line &l = lines.at(pos++);
+        if (size_t(l.length) != line->content_len ||
+                std::memcmp(preimage.constData() + l.offset, line->content, line->content_len) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Looks for the position where the preimage lines of a hunk match, starting at the
+ * position recorded in the hunk header and moving away from it in both directions,
+ * as `git apply` does when the preimage has been shifted by other changes.
+ */
+int findHunk(const QByteArray &preimage, const QVector<Line> &lines, int cursor, int expected,
+             const QVector<const git_diff_line*> &hunkLines, int preimageCount)
+{
+    const int last = lines.size() - preimageCount;
+    if (last < cursor) {
+        return -1;
+    }
+
+    expected = qBound(cursor, expected, last);
+    for (int offset = 0; expected - offset >= cursor || expected + offset <= last; ++offset) {
+        if (expected - offset >= cursor && hunkMatches(preimage, lines, expected - offset, hunkLines)) {
+            return expected - offset;
+        }
+        if (offset > 0 && expected + offset <= last && hunkMatches(preimage, lines, expected + offset, hunkLines)) {
+            return expected + offset;
+        }
+    }
+    return -1;
+}
+
+bool readDeltaSize(const unsigned char *&p, const unsigned char *end, size_t &size)
+{
+    size = 0;
+    int shift = 0;
+    unsigned char c;
+    do {
+        if (p == end) {
+            return false;
+        }
+        c = *p++;
+        size |= size_t(c & 0x7f) << shift;
+        shift += 7;
+    } while (c & 0x80);
+    return true;
+}
+
+/**
+ * Applies a git binary delta (a sequence of copy and insert instructions) to \a base.
+ */
+bool applyDelta(const QByteArray &base, const QByteArray &delta, QByteArray &result)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(delta.constData());
+    const unsigned char *end = p + delta.size();
+
+    size_t baseSize, resultSize;
+    if (!readDeltaSize(p, end, baseSize) || baseSize != size_t(base.size()) || !readDeltaSize(p, end, resultSize)
+            || resultSize > MaxBinarySize) {
+        return false;
+    }
+
+    result.clear();
+    result.reserve(int(resultSize));
+    while (p < end) {
+        const unsigned char op = *p++;
+        if (op & 0x80) {
+            size_t offset = 0, length = 0;
+            for (int i = 0; i < 4; ++i) {
+                if (op & (0x01 << i)) {
+                    if (p == end) {
+                        return false;
+                    }
+                    offset |= size_t(*p++) << (8 * i);
+                }
+            }
+            for (int i = 0; i < 3; ++i) {
+                if (op & (0x10 << i)) {
+                    if (p == end) {
+                        return false;
+                    }
+                    length |= size_t(*p++) << (8 * i);
+                }
+            }
+            if (length == 0) {
+                length = 0x10000;
+            }
+            if (offset + length > baseSize || size_t(result.size()) + length > resultSize) {
+                return false;
+            }
+            result.append(base.constData() + offset, int(length));
+        } else if (op != 0) {
+            if (size_t(end - p) < op || size_t(result.size()) + op > resultSize) {
+                return false;
+            }
+            result.append(reinterpret_cast<const char*>(p), op);
+            p += op;
+        } else {
+            return false;
+        }
+    }
+    return size_t(result.size()) == resultSize;
+}
+
+QByteArray inflate(const QByteArray &data, size_t inflatedLength)
+{
+    if (inflatedLength == 0 || inflatedLength > MaxBinarySize) {
+        return QByteArray();
+    }
+
+    // qUncompress() expects the zlib stream to be prefixed with the big endian inflated size
+    const quint32 size = quint32(inflatedLength);
+    QByteArray prefixed;
+    prefixed.reserve(data.size() + 4);
+    prefixed.append(char(size >> 24)).append(char(size >> 16)).append(char(size >> 8)).append(char(size));
+    prefixed.append(data);
+    return qUncompress(prefixed);
+}
+
+Q_NORETURN void failPatch(const char *path, const QString &reason)
+{
+    throw Exception(QString("patch failed: %1: %2").arg(PathCodec::fromLibGit2(path), reason));
+}
+
+}
+
+
+PatchApplier::PatchApplier(git_repository *repo, git_diff *diff) :
+    m_repo(repo),
+    m_diff(diff),
+    m_odb(0),
+    m_binariesCollected(false)
+{
+    qGitThrow(git_repository_odb(&m_odb, m_repo));
+}
+
+PatchApplier::~PatchApplier()
+{
+    git_odb_free(m_odb);
+}
+
+void PatchApplier::applyToIndex(git_index *index)
+{
+    // every postimage is computed and only hashed before anything is written, so a
+    // failing delta leaves neither the index nor the object database changed
+    struct IndexChange {
+        const char *removedPath;
+        bool add;
+        git_index_entry entry;
+        bool store;             // the postimage is in content, not stored yet
+        QByteArray content;
+    };
+    QVector<IndexChange> changes;
+    QSet<QByteArray> removed;
+    QSet<QByteArray> added;
+
+    const size_t numDeltas = git_diff_num_deltas(m_diff);
+    for (size_t idx = 0; idx < numDeltas; ++idx) {
+        const git_diff_delta *delta = git_diff_get_delta(m_diff, idx);
+        const char *oldPath = delta->old_file.path;
+        const char *newPath = delta->new_file.path;
+
+        IndexChange change;
+        change.removedPath = 0;
+        change.add = false;
+        change.store = false;
+
+        const git_index_entry *base = removed.contains(oldPath) ? NULL : git_index_get_bypath(index, oldPath, 0);
+        switch (delta->status) {
+        case GIT_DELTA_UNMODIFIED:
+        case GIT_DELTA_IGNORED:
+            continue;
+        case GIT_DELTA_DELETED:
+            if (base == NULL) {
+                failPatch(oldPath, "does not exist in index");
+            }
+            change.removedPath = oldPath;
+            removed.insert(oldPath);
+            changes.append(change);
+            continue;
+        default:
+            break;
+        }
+
+        const bool isNew = delta->status == GIT_DELTA_ADDED || delta->status == GIT_DELTA_UNTRACKED;
+        if (isNew && (base != NULL || added.contains(newPath))) {
+            failPatch(newPath, "already exists in index");
+        } else if (!isNew && base == NULL) {
+            failPatch(oldPath, "does not exist in index");
+        }
+
+        git_index_entry &entry = change.entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.mode = delta->new_file.mode;
+        entry.path = newPath;
+
+        if (delta->new_file.mode == GIT_FILEMODE_COMMIT || hasPostimageBlob(delta, isNew ? NULL : &base->id)) {
+            git_oid_cpy(&entry.id, &delta->new_file.id);
+            entry.file_size = uint32_t(delta->new_file.size);
+        } else {
+            change.store = true;
+            change.content = postimage(idx, delta, isNew ? QByteArray() : blobContent(&base->id));
+            qGitThrow(git_odb_hash(&entry.id, change.content.constData(), size_t(change.content.size()), GIT_OBJ_BLOB));
+            entry.file_size = uint32_t(change.content.size());
+        }
+
+        if (delta->status == GIT_DELTA_RENAMED) {
+            change.removedPath = oldPath;
+            removed.insert(oldPath);
+        }
+        change.add = true;
+        removed.remove(newPath);
+        added.insert(newPath);
+        changes.append(change);
+    }
+
+    foreach (const IndexChange &change, changes) {
+        if (change.store) {
+            git_oid id;
+            qGitThrow(git_blob_create_frombuffer(&id, m_repo, change.content.constData(), size_t(change.content.size())));
+        }
+    }
+    foreach (const IndexChange &change, changes) {
+        if (change.removedPath != NULL) {
+            qGitThrow(git_index_remove_bypath(index, change.removedPath));
+        }
+        if (change.add) {
+            qGitThrow(git_index_add(index, &change.entry));
+        }
+    }
+}
+
+void PatchApplier::applyToWorkdir()
+{
+    const char *workdir = git_repository_workdir(m_repo);
+    if (workdir == NULL) {
+        throw Exception("cannot apply a patch to the working directory of a bare repository");
+    }
+    const QString root = PathCodec::fromLibGit2(workdir);
+
+    // first pass: check every delta against the working directory and compute all the
+    // postimages, so a patch that doesn't apply leaves no file modified
+    struct WorkdirChange {
+        const git_diff_delta *delta;
+        QString oldFile;
+        QString newFile;
+        QByteArray content;
+    };
+    QVector<WorkdirChange> changes;
+    QSet<QString> removed;
+    QSet<QString> written;
+
+    const size_t numDeltas = git_diff_num_deltas(m_diff);
+    for (size_t idx = 0; idx < numDeltas; ++idx) {
+        const git_diff_delta *delta = git_diff_get_delta(m_diff, idx);
+        const char *oldPath = delta->old_file.path;
+        const char *newPath = delta->new_file.path;
+
+        WorkdirChange change;
+        change.delta = delta;
+        change.oldFile = root + PathCodec::fromLibGit2(oldPath);
+        change.newFile = root + PathCodec::fromLibGit2(newPath);
+        const QFileInfo oldInfo(change.oldFile);
+        const bool oldExists = !removed.contains(change.oldFile) && (oldInfo.exists() || oldInfo.isSymLink());
+
+        switch (delta->status) {
+        case GIT_DELTA_UNMODIFIED:
+        case GIT_DELTA_IGNORED:
+            continue;
+        case GIT_DELTA_DELETED:
+            if (!oldExists || written.contains(change.oldFile)) {
+                failPatch(oldPath, "does not exist in working directory");
+            }
+            if (delta->old_file.mode != GIT_FILEMODE_COMMIT && !matchesPreimage(delta, change.oldFile)) {
+                failPatch(oldPath, "does not match the preimage of the deletion");
+            }
+            removed.insert(change.oldFile);
+            changes.append(change);
+            continue;
+        default:
+            break;
+        }
+
+        // submodules are not touched, like `git apply` does
+        if (delta->new_file.mode == GIT_FILEMODE_COMMIT) {
+            continue;
+        }
+
+        const bool isNew = delta->status == GIT_DELTA_ADDED || delta->status == GIT_DELTA_UNTRACKED;
+        const bool movesFile = delta->status == GIT_DELTA_RENAMED && change.oldFile != change.newFile;
+        if (isNew || movesFile) {
+            const QFileInfo newInfo(change.newFile);
+            if (written.contains(change.newFile) ||
+                    (!removed.contains(change.newFile) && (newInfo.exists() || newInfo.isSymLink()))) {
+                failPatch(newPath, "already exists in working directory");
+            }
+        }
+        if (!isNew && !oldExists) {
+            failPatch(oldPath, "does not exist in working directory");
+        }
+
+        if (delta->old_file.mode == GIT_FILEMODE_LINK || delta->new_file.mode == GIT_FILEMODE_LINK) {
+            if (!hasPostimageBlob(delta, NULL)) {
+                failPatch(newPath, "symbolic links can only be patched from a stored blob");
+            }
+            change.content = blobContent(&delta->new_file.id);
+        } else {
+            QByteArray preimage;
+            if (!isNew) {
+                QFile file(change.oldFile);
+                if (!file.open(QIODevice::ReadOnly)) {
+                    failPatch(oldPath, "does not exist in working directory");
+                }
+                preimage = file.readAll();
+            }
+
+            git_oid preimageId;
+            qGitThrow(git_odb_hash(&preimageId, preimage.constData(), size_t(preimage.size()), GIT_OBJ_BLOB));
+            if (hasPostimageBlob(delta, isNew ? NULL : &preimageId)) {
+                change.content = blobContent(&delta->new_file.id);
+            } else {
+                change.store = true;
+            change.content = postimage(idx, delta, preimage);
+            }
+        }
+
+        if (movesFile) {
+            removed.insert(change.oldFile);
+        }
+        removed.remove(change.newFile);
+        written.insert(change.newFile);
+        changes.append(change);
+    }
+
+    // second pass: write the postimages
+    foreach (const WorkdirChange &change, changes) {
+        const git_diff_delta *delta = change.delta;
+        const char *oldPath = delta->old_file.path;
+        const char *newPath = delta->new_file.path;
+
+        if (delta->status == GIT_DELTA_DELETED) {
+            if (!QFile::remove(change.oldFile)) {
+                failPatch(oldPath, "could not be removed from the working directory");
+            }
+            continue;
+        }
+
+        QDir().mkpath(QFileInfo(change.newFile).absolutePath());
+        if (delta->new_file.mode == GIT_FILEMODE_LINK) {
+            QFile::remove(change.newFile);
+            if (!QFile::link(PathCodec::fromLibGit2(change.content), change.newFile)) {
+                failPatch(newPath, "could not create the symbolic link");
+            }
+        } else {
+            QSaveFile file(change.newFile);
+            if (!file.open(QIODevice::WriteOnly) || file.write(change.content) != change.content.size() || !file.commit()) {
+                failPatch(newPath, "could not be written to the working directory");
+            }
+
+            QFile::Permissions permissions = QFile::permissions(change.newFile);
+            if (delta->new_file.mode == GIT_FILEMODE_BLOB_EXECUTABLE) {
+                permissions |= QFile::ExeOwner | QFile::ExeUser | QFile::ExeGroup | QFile::ExeOther;
+            } else {
+                permissions &= ~(QFile::ExeOwner | QFile::ExeUser | QFile::ExeGroup | QFile::ExeOther);
+            }
+            QFile::setPermissions(change.newFile, permissions);
+        }
+
+        if (delta->status == GIT_DELTA_RENAMED && change.oldFile != change.newFile && !QFile::remove(change.oldFile)) {
+            failPatch(oldPath, "could not be removed from the working directory");
+        }
+    }
+}
+
+bool PatchApplier::matchesPreimage(const git_diff_delta *delta, const QString &file)
+{
+    if (!(delta->old_file.flags & GIT_DIFF_FLAG_VALID_ID) || git_oid_iszero(&delta->old_file.id)) {
+        // nothing to compare with, e.g. a deletion parsed without the full index line
+        return true;
+    }
+
+    if (delta->old_file.mode == GIT_FILEMODE_LINK) {
+        // Qt only gives the resolved target of a link, so only its type is checked
+        return QFileInfo(file).isSymLink();
+    }
+
+    // hashed with the filters applied, as the preimage stored in the repository
+    git_oid id;
+    qGitThrow(git_repository_hashfile(&id, m_repo, PathCodec::toLibGit2(file), GIT_OBJ_BLOB, delta->old_file.path));
+    return git_oid_equal(&id, &delta->old_file.id);
+}
+
+bool PatchApplier::hasPostimageBlob(const git_diff_delta *delta, const git_oid *preimageId)
+{
+    if (!(delta->new_file.flags & GIT_DIFF_FLAG_VALID_ID) || git_oid_iszero(&delta->new_file.id)) {
+        return false;
+    }
+    if (preimageId != NULL && (!(delta->old_file.flags & GIT_DIFF_FLAG_VALID_ID) || !git_oid_equal(preimageId, &delta->old_file.id))) {
+        return false;
+    }
+    return git_odb_exists(m_odb, &delta->new_file.id) == 1;
+}
+
+QByteArray PatchApplier::postimage(size_t idx, const git_diff_delta *delta, const QByteArray &preimage)
+{
+    git_patch *rawPatch = 0;
+    qGitThrow(git_patch_from_diff(&rawPatch, m_diff, idx));
+    QSharedPointer<git_patch> patch(rawPatch, git_patch_free);
+
+    if (delta->flags & GIT_DIFF_FLAG_BINARY) {
+        return applyBinary(delta, preimage);
+    } else if (patch.isNull()) {
+        return preimage;
+    }
+    return applyHunks(patch.data(), preimage, delta->new_file.path);
+}
+
+QByteArray PatchApplier::applyHunks(git_patch *patch, const QByteArray &preimage, const char *path)
+{
+    const QVector<Line> lines = splitLines(preimage);
+    QByteArray result;
+    result.reserve(preimage.size());
+
+    int cursor = 0;
+    const size_t numHunks = git_patch_num_hunks(patch);
+    for (size_t h = 0; h < numHunks; ++h) {
+        const git_diff_hunk *hunk = 0;
+        size_t numLines = 0;
+        qGitThrow(git_patch_get_hunk(&hunk, &numLines, patch, h));
+
+        QVector<const git_diff_line*> hunkLines;
+        hunkLines.reserve(int(numLines));
+        int preimageCount = 0;
+        for (size_t l = 0; l < numLines; ++l) {
+            const git_diff_line *line = 0;
+            qGitThrow(git_patch_get_line_in_hunk(&line, patch, h, l));
+            hunkLines.append(line);
+            if (isPreimageLine(line)) {
+                ++preimageCount;
+            }
+        }
+
+        // an empty preimage range starts after the line given in the header
+        const int expected = hunk->old_lines == 0 ? hunk->old_start : hunk->old_start - 1;
+        const int pos = findHunk(preimage, lines, cursor, expected, hunkLines, preimageCount);
+        if (pos < 0) {
+            failPatch(path, QString("hunk #%1 does not apply").arg(int(h) + 1));
+        }
+
+        for (; cursor < pos; ++cursor) {
+            result.append(preimage.constData() + lines.at(cursor).offset, lines.at(cursor).length);
+        }
+        foreach (const git_diff_line *line, hunkLines) {
+            if (isPostimageLine(line)) {
+                result.append(line->content, int(line->content_len));
+            }
+        }
+        cursor = pos + preimageCount;
+    }
+
+    for (; cursor < lines.size(); ++cursor) {
+        result.append(preimage.constData() + lines.at(cursor).offset, lines.at(cursor).length);
+    }
+    return result;
+}
+
+QByteArray PatchApplier::applyBinary(const git_diff_delta *delta, const QByteArray &preimage)
+{
+    if (!m_binariesCollected) {
+        qGitThrow(git_diff_foreach(m_diff, NULL, &collectBinaryCallback, NULL, NULL, this));
+        m_binariesCollected = true;
+    }
+
+    QHash<const git_diff_delta*, BinaryData>::const_iterator binary = m_binaries.constFind(delta);
+    if (binary == m_binaries.constEnd() || binary->type == GIT_DIFF_BINARY_NONE) {
+        failPatch(delta->new_file.path, "binary patch without data, the Diff must be generated with GIT_DIFF_SHOW_BINARY");
+    }
+
+    const QByteArray data = inflate(binary->data, binary->inflatedLength);
+    if (size_t(data.size()) != binary->inflatedLength) {
+        failPatch(delta->new_file.path, "corrupt binary patch");
+    }
+
+    if (binary->type == GIT_DIFF_BINARY_LITERAL) {
+        return data;
+    }
+
+    QByteArray result;
+    if (!applyDelta(preimage, data, result)) {
+        failPatch(delta->new_file.path, "binary patch does not apply");
+    }
+    return result;
+}
+
+QByteArray PatchApplier::blobContent(const git_oid *id)
+{
+    git_blob *blob = 0;
+    qGitThrow(git_blob_lookup(&blob, m_repo, id));
+    const QByteArray content(static_cast<const char*>(git_blob_rawcontent(blob)), int(git_blob_rawsize(blob)));
+    git_blob_free(blob);
+    return content;
+}
+
+int PatchApplier::collectBinaryCallback(const git_diff_delta *delta, const git_diff_binary *binary, void *payload)
+{
+    PatchApplier *applier = static_cast<PatchApplier*>(payload);
+
+    BinaryData data;
+    data.type = binary->new_file.type;
+    data.data = QByteArray(binary->new_file.data, int(binary->new_file.datalen));
+    data.inflatedLength = binary->new_file.inflatedlen;
+    applier->m_binaries.insert(delta, data);
+    return 0;
+}
+
+}
+}
@@ -0,0 +1,90 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_PATCHAPPLIER_H
+#define LIBQGIT2_PATCHAPPLIER_H
+
+#include "git2.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+namespace LibQGit2 {
+namespace internal {
+
+/**
+ * Applies the deltas of a git_diff in process, either to an index or to the
+ * working directory of a repository.
+ *
+ * When the postimage of a delta is already stored in the object database (as
+ * for diffs between trees) it is used directly; otherwise the textual hunks of
+ * the patch are applied to the preimage, or the binary patch data if the diff
+ * was generated with GIT_DIFF_SHOW_BINARY.
+ */
+class PatchApplier
+{
+public:
+    PatchApplier(git_repository *repo, git_diff *diff);
+    ~PatchApplier();
+
+    PatchApplier(const PatchApplier &other) = delete;
+    PatchApplier &operator=(const PatchApplier &rhs) = delete;
+
+    /**
+     * Applies all the deltas to the stage 0 entries of \a index. Nothing is changed
+     * unless all of them apply.
+     * @throws LibQGit2::Exception
+     */
+    void applyToIndex(git_index *index);
+
+    /**
+     * Applies all the deltas to the files in the working directory. All the postimages
+     * are computed, and the preimages of the deletions checked, before any file is
+     * written, so a patch that doesn't apply leaves the working directory untouched.
+     * @throws LibQGit2::Exception
+     */
+    void applyToWorkdir();
+
+private:
+    struct BinaryData {
+        git_diff_binary_t type;
+        QByteArray data;
+        size_t inflatedLength;
+    };
+
+    bool hasPostimageBlob(const git_diff_delta *delta, const git_oid *preimageId);
+    bool matchesPreimage(const git_diff_delta *delta, const QString &file);
+    QByteArray postimage(size_t idx, const git_diff_delta *delta, const QByteArray &preimage);
+    QByteArray applyHunks(git_patch *patch, const QByteArray &preimage, const char *path);
+    QByteArray applyBinary(const git_diff_delta *delta, const QByteArray &preimage);
+    QByteArray blobContent(const git_oid *id);
+
+    static int collectBinaryCallback(const git_diff_delta *delta, const git_diff_binary *binary, void *payload);
+
+    git_repository *m_repo;
+    git_diff *m_diff;
+    git_odb *m_odb;
+    bool m_binariesCollected;
+    QHash<const git_diff_delta*, BinaryData> m_binaries;
+};
+
+}
+}
+
+#endif // LIBQGIT2_PATCHAPPLIER_H
@@ -0,0 +1,54 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "pathcompare.h"
+
+namespace LibQGit2 {
+namespace internal {
+
+namespace {
+
+inline unsigned char toAsciiLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c - 'A' + 'a') : (unsigned char)c;
+}
+
+}
+
+int compareIgnoringAsciiCase(const char *a, const char *b)
+{
+    while (*a && toAsciiLower(*a) == toAsciiLower(*b)) {
+        ++a;
+        ++b;
+    }
+    return int(toAsciiLower(*a)) - int(toAsciiLower(*b));
+}
+
+int compareIgnoringAsciiCase(const char *a, const char *b, size_t length)
+{
+    for (; length > 0; --length, ++a, ++b) {
+        const int diff = int(toAsciiLower(*a)) - int(toAsciiLower(*b));
+        if (diff != 0 || !*a) {
+            return diff;
+        }
+    }
+    return 0;
+}
+
+}
+}
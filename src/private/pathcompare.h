@@ -0,0 +1,43 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_PATHCOMPARE_H
+#define LIBQGIT2_PATHCOMPARE_H
+
+#include <cstddef>
+
+namespace LibQGit2 {
+namespace internal {
+
+/**
+ * Compares the paths \a a and \a b like strcmp(), but with the ASCII letters folded
+ * to lower case, which is how libgit2 orders the entries of a case-insensitive index.
+ * Unlike qstricmp(), which folds Latin-1, every other byte, e.g. of a multibyte UTF-8
+ * sequence, is compared as it is.
+ */
+int compareIgnoringAsciiCase(const char *a, const char *b);
+
+/**
+ * The same as compareIgnoringAsciiCase(), but comparing at most \a length bytes.
+ */
+int compareIgnoringAsciiCase(const char *a, const char *b, size_t length);
+
+}
+}
+
+#endif // LIBQGIT2_PATHCOMPARE_H
@@ -0,0 +1,118 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "refsnapshot.h"
+
+#include "qgitexception.h"
+#include "private/pathcodec.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+namespace LibQGit2 {
+namespace internal {
+
+namespace {
+
+// files modified within this window before they were read may be modified again
+// without their timestamp changing, on file systems with a coarse resolution
+const qint64 RacyWindowMsecs = 2000;
+
+// as in libgit2
+const int MaxSymbolicDepth = 5;
+
+}
+
+RefSnapshot::RefSnapshot(const QString &gitDir)
+    : m_gitDir(gitDir)
+{
+    if (!m_gitDir.endsWith(QChar('/'))) {
+        m_gitDir += QChar('/');
+    }
+}
+
+OId RefSnapshot::resolve(git_repository *repo, const QString &name)
+{
+    // the files are stat'ed without holding the lock
+    m_mutex.lock();
+    const Entry remembered = m_entries.value(name);
+    m_mutex.unlock();
+    if (!remembered.files.isEmpty() && isCurrent(remembered)) {
+        return remembered.oid;
+    }
+
+    const qint64 started = QDateTime::currentMSecsSinceEpoch();
+    Entry entry;
+    entry.files.append(stamp(m_gitDir + "packed-refs"));
+
+    QByteArray refName = PathCodec::toLibGit2(name);
+    for (int depth = 0; ; ++depth) {
+        if (depth > MaxSymbolicDepth) {
+            throw Exception("Repository::lookupRefOId(): too many nested symbolic references for " + name);
+        }
+
+        git_reference *ref = 0;
+        qGitThrow(git_reference_lookup(&ref, repo, refName));
+        entry.files.append(stamp(m_gitDir + PathCodec::fromLibGit2(refName)));
+
+        if (git_reference_type(ref) == GIT_REF_OID) {
+            entry.oid = OId(git_reference_target(ref));
+            git_reference_free(ref);
+            break;
+        }
+        refName = git_reference_symbolic_target(ref);
+        git_reference_free(ref);
+    }
+
+    bool racy = false;
+    foreach (const FileStamp &file, entry.files) {
+        racy = racy || file.modified > started - RacyWindowMsecs;
+    }
+    QMutexLocker lock(&m_mutex);
+    if (racy) {
+        m_entries.remove(name);
+    } else {
+        m_entries.insert(name, entry);
+    }
+    return entry.oid;
+}
+
+RefSnapshot::FileStamp RefSnapshot::stamp(const QString &path)
+{
+    const QFileInfo info(path);
+    FileStamp file;
+    file.path = path;
+    file.modified = info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+    file.size = info.size();
+    return file;
+}
+
+bool RefSnapshot::isCurrent(const Entry &entry)
+{
+    foreach (const FileStamp &file, entry.files) {
+        const FileStamp current = stamp(file.path);
+        if (current.modified != file.modified || current.size != file.size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+}
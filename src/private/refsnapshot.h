@@ -0,0 +1,79 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_REFSNAPSHOT_H
+#define LIBQGIT2_REFSNAPSHOT_H
+
+#include "git2.h"
+
+#include "qgitoid.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+namespace LibQGit2 {
+namespace internal {
+
+/**
+ * Remembers the ids references resolved to, together with the stat data of the
+ * files the resolution read: packed-refs and the loose file of every reference in
+ * the symbolic chain. A remembered id is returned as long as none of these files
+ * changed, which costs a few stat calls instead of reading and parsing them.
+ *
+ * References whose files were modified too recently to tell a later modification
+ * apart by their timestamp are not remembered.
+ *
+ * A snapshot is shared by the copies of a Repository, so it is thread-safe.
+ */
+class RefSnapshot
+{
+public:
+    explicit RefSnapshot(const QString &gitDir);
+
+    /**
+     * Returns the id \a name resolves to in \a repo.
+     * @throws LibQGit2::Exception
+     */
+    OId resolve(git_repository *repo, const QString &name);
+
+private:
+    struct FileStamp {
+        QString path;
+        qint64 modified;
+        qint64 size;
+    };
+
+    struct Entry {
+        OId oid;
+        QVector<FileStamp> files;
+    };
+
+    static FileStamp stamp(const QString &path);
+    static bool isCurrent(const Entry &entry);
+
+    QString m_gitDir;
+    QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+};
+
+}
+}
+
+#endif // LIBQGIT2_REFSNAPSHOT_H
@@ -0,0 +1,243 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "statusdiffs.h"
+
+#include "qgitexception.h"
+#include "private/pathcompare.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace LibQGit2 {
+namespace internal {
+
+namespace {
+
+typedef int (*PathCompare)(const char *a, const char *b);
+
+int compareCaseSensitively(const char *a, const char *b)
+{
+    return strcmp(a, b);
+}
+
+int compareIgnoringCase(const char *a, const char *b)
+{
+    return compareIgnoringAsciiCase(a, b);
+}
+
+unsigned int headToIndexStatus(const git_diff_delta *delta)
+{
+    switch (delta->status) {
+    case GIT_DELTA_ADDED:
+    case GIT_DELTA_COPIED:
+        return GIT_STATUS_INDEX_NEW;
+    case GIT_DELTA_DELETED:
+        return GIT_STATUS_INDEX_DELETED;
+    case GIT_DELTA_MODIFIED:
+        return GIT_STATUS_INDEX_MODIFIED;
+    case GIT_DELTA_RENAMED:
+        return git_oid_equal(&delta->old_file.id, &delta->new_file.id)
+                ? GIT_STATUS_INDEX_RENAMED : GIT_STATUS_INDEX_RENAMED | GIT_STATUS_INDEX_MODIFIED;
+    case GIT_DELTA_TYPECHANGE:
+        return GIT_STATUS_INDEX_TYPECHANGE;
+    case GIT_DELTA_CONFLICTED:
+        return GIT_STATUS_CONFLICTED;
+    default:
+        return GIT_STATUS_CURRENT;
+    }
+}
+
+unsigned int indexToWorkdirStatus(git_repository *repo, const git_diff_delta *delta)
+{
+    switch (delta->status) {
+    case GIT_DELTA_ADDED:
+    case GIT_DELTA_COPIED:
+    case GIT_DELTA_UNTRACKED:
+        return GIT_STATUS_WT_NEW;
+    case GIT_DELTA_UNREADABLE:
+        return GIT_STATUS_WT_UNREADABLE;
+    case GIT_DELTA_DELETED:
+        return GIT_STATUS_WT_DELETED;
+    case GIT_DELTA_MODIFIED:
+        return GIT_STATUS_WT_MODIFIED;
+    case GIT_DELTA_IGNORED:
+        return GIT_STATUS_IGNORED;
+    case GIT_DELTA_RENAMED: {
+        // the id of the renamed file may not have been computed yet
+        git_oid id = delta->new_file.id;
+        if (git_oid_iszero(&id)) {
+            qGitThrow(git_repository_hashfile(&id, repo, delta->new_file.path, GIT_OBJ_BLOB, NULL));
+        }
+        return git_oid_equal(&delta->old_file.id, &id)
+                ? GIT_STATUS_WT_RENAMED : GIT_STATUS_WT_RENAMED | GIT_STATUS_WT_MODIFIED;
+    }
+    case GIT_DELTA_TYPECHANGE:
+        return GIT_STATUS_WT_TYPECHANGE;
+    case GIT_DELTA_CONFLICTED:
+        return GIT_STATUS_CONFLICTED;
+    default:
+        return GIT_STATUS_CURRENT;
+    }
+}
+
+bool isSubmoduleOnly(const git_diff_delta *delta)
+{
+    return (delta->status == GIT_DELTA_ADDED || delta->old_file.mode == GIT_FILEMODE_COMMIT)
+            && (delta->status == GIT_DELTA_DELETED || delta->new_file.mode == GIT_FILEMODE_COMMIT);
+}
+
+QVector<const git_diff_delta *> sortedDeltas(git_diff *diff, bool byNewPath, PathCompare compare)
+{
+    QVector<const git_diff_delta *> deltas;
+    if (diff) {
+        const size_t count = git_diff_num_deltas(diff);
+        deltas.reserve(int(count));
+        for (size_t i = 0; i < count; ++i) {
+            deltas.append(git_diff_get_delta(diff, i));
+        }
+        std::stable_sort(deltas.begin(), deltas.end(), [byNewPath, compare](const git_diff_delta *a, const git_diff_delta *b) {
+            return byNewPath ? compare(a->new_file.path, b->new_file.path) < 0
+                             : compare(a->old_file.path, b->old_file.path) < 0;
+        });
+    }
+    return deltas;
+}
+
+}
+
+StatusDiffs::StatusDiffs(git_repository *repo, git_index *index, const git_status_options &options)
+{
+    if (git_repository_is_bare(repo)) {
+        throw Exception("Repository::status(): the repository has no working directory");
+    }
+
+    // the options git_status_list_new() derives from the status options
+    const unsigned int flags = options.flags;
+    git_diff_options diffOptions = GIT_DIFF_OPTIONS_INIT;
+    diffOptions.pathspec = options.pathspec;
+    diffOptions.flags = GIT_DIFF_INCLUDE_TYPECHANGE;
+    const struct {
+        unsigned int status;
+        unsigned int diff;
+    } flagMap[] = {
+        { GIT_STATUS_OPT_INCLUDE_UNTRACKED, GIT_DIFF_INCLUDE_UNTRACKED },
+        { GIT_STATUS_OPT_INCLUDE_IGNORED, GIT_DIFF_INCLUDE_IGNORED },
+        { GIT_STATUS_OPT_INCLUDE_UNMODIFIED, GIT_DIFF_INCLUDE_UNMODIFIED },
+        { GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS, GIT_DIFF_RECURSE_UNTRACKED_DIRS },
+        { GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH, GIT_DIFF_DISABLE_PATHSPEC_MATCH },
+        { GIT_STATUS_OPT_RECURSE_IGNORED_DIRS, GIT_DIFF_RECURSE_IGNORED_DIRS },
+        { GIT_STATUS_OPT_EXCLUDE_SUBMODULES, GIT_DIFF_IGNORE_SUBMODULES },
+        { GIT_STATUS_OPT_UPDATE_INDEX, GIT_DIFF_UPDATE_INDEX },
+        { GIT_STATUS_OPT_INCLUDE_UNREADABLE, GIT_DIFF_INCLUDE_UNREADABLE },
+        { GIT_STATUS_OPT_INCLUDE_UNREADABLE_AS_UNTRACKED, GIT_DIFF_INCLUDE_UNREADABLE_AS_UNTRACKED }
+    };
+    for (const auto &mapping : flagMap) {
+        if (flags & mapping.status) {
+            diffOptions.flags |= mapping.diff;
+        }
+    }
+
+    git_diff_find_options findOptions = GIT_DIFF_FIND_OPTIONS_INIT;
+    findOptions.flags = GIT_DIFF_FIND_FOR_UNTRACKED;
+    if (flags & GIT_STATUS_OPT_RENAMES_FROM_REWRITES) {
+        findOptions.flags |= GIT_DIFF_FIND_AND_BREAK_REWRITES | GIT_DIFF_FIND_RENAMES_FROM_REWRITES
+                | GIT_DIFF_BREAK_REWRITES_FOR_RENAMES_ONLY;
+    }
+
+    if (options.show != GIT_STATUS_SHOW_WORKDIR_ONLY) {
+        git_object *tree = 0;
+        const int error = git_revparse_single(&tree, repo, "HEAD^{tree}");
+        if (error == GIT_ENOTFOUND || error == GIT_EUNBORNBRANCH) {
+            // everything is staged
+            giterr_clear();
+        } else {
+            qGitThrow(error);
+        }
+        QSharedPointer<git_object> treeGuard(tree, git_object_free);
+
+        git_diff *diff = 0;
+        qGitThrow(git_diff_tree_to_index(&diff, repo, reinterpret_cast<git_tree*>(tree), index, &diffOptions));
+        m_headToIndex = QSharedPointer<git_diff>(diff, git_diff_free);
+        if (flags & GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX) {
+            qGitThrow(git_diff_find_similar(diff, &findOptions));
+        }
+    }
+
+    if (options.show != GIT_STATUS_SHOW_INDEX_ONLY) {
+        git_diff *diff = 0;
+        qGitThrow(git_diff_index_to_workdir(&diff, repo, index, &diffOptions));
+        m_indexToWorkdir = QSharedPointer<git_diff>(diff, git_diff_free);
+        if (flags & GIT_STATUS_OPT_RENAMES_INDEX_TO_WORKDIR) {
+            qGitThrow(git_diff_find_similar(diff, &findOptions));
+        }
+    }
+
+    // pair the deltas of a path, as git_status_list_new() does
+    const bool ignoreCase = git_index_caps(index) & GIT_INDEXCAP_IGNORE_CASE;
+    const PathCompare compare = ignoreCase ? compareIgnoringCase : compareCaseSensitively;
+    const QVector<const git_diff_delta *> headToIndex = sortedDeltas(m_headToIndex.data(), true, compare);
+    const QVector<const git_diff_delta *> indexToWorkdir = sortedDeltas(m_indexToWorkdir.data(), false, compare);
+    const bool excludeSubmodules = flags & GIT_STATUS_OPT_EXCLUDE_SUBMODULES;
+    m_entries.reserve(qMax(headToIndex.size(), indexToWorkdir.size()));
+
+    for (int i = 0, j = 0; i < headToIndex.size() || j < indexToWorkdir.size(); ) {
+        const git_diff_delta *staged = i < headToIndex.size() ? headToIndex.at(i) : 0;
+        const git_diff_delta *changed = j < indexToWorkdir.size() ? indexToWorkdir.at(j) : 0;
+        const int cmp = !changed ? -1 : !staged ? 1 : compare(staged->new_file.path, changed->old_file.path);
+        if (cmp < 0) {
+            ++i;
+            changed = 0;
+        } else if (cmp > 0) {
+            ++j;
+            staged = 0;
+        } else {
+            ++i;
+            ++j;
+        }
+
+        if (excludeSubmodules && (!staged || isSubmoduleOnly(staged)) && (!changed || isSubmoduleOnly(changed))) {
+            continue;
+        }
+        git_status_entry entry;
+        entry.status = git_status_t((staged ? headToIndexStatus(staged) : 0)
+                                    | (changed ? indexToWorkdirStatus(repo, changed) : 0));
+        entry.head_to_index = const_cast<git_diff_delta *>(staged);
+        entry.index_to_workdir = const_cast<git_diff_delta *>(changed);
+        m_entries.append(entry);
+    }
+
+    if (flags & (GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX | GIT_STATUS_OPT_RENAMES_INDEX_TO_WORKDIR
+                 | GIT_STATUS_OPT_SORT_CASE_SENSITIVELY | GIT_STATUS_OPT_SORT_CASE_INSENSITIVELY)) {
+        const PathCompare sortCompare = (flags & GIT_STATUS_OPT_SORT_CASE_INSENSITIVELY) ? compareIgnoringCase
+                : (flags & GIT_STATUS_OPT_SORT_CASE_SENSITIVELY) ? compareCaseSensitively : compare;
+        std::stable_sort(m_entries.begin(), m_entries.end(), [sortCompare](const git_status_entry &a, const git_status_entry &b) {
+            const git_diff_delta *deltaA = a.index_to_workdir ? a.index_to_workdir : a.head_to_index;
+            const git_diff_delta *deltaB = b.index_to_workdir ? b.index_to_workdir : b.head_to_index;
+            return sortCompare(deltaA->new_file.path, deltaB->new_file.path) < 0;
+        });
+    }
+}
+
+const QVector<git_status_entry> &StatusDiffs::entries() const
+{
+    return m_entries;
+}
+
+}
+}
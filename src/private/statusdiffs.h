@@ -0,0 +1,66 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_STATUSDIFFS_H
+#define LIBQGIT2_STATUSDIFFS_H
+
+#include "git2.h"
+
+#include <QSharedPointer>
+#include <QVector>
+
+namespace LibQGit2 {
+namespace internal {
+
+/**
+ * The status of the working directory of a repository, computed against a given
+ * index instead of the index of the repository.
+ *
+ * git_status_list_new() always compares with the index of the repository. This pairs
+ * the entries of a HEAD to \a index diff and of an \a index to working directory diff
+ * the way it does, so the repository and its index are left untouched.
+ */
+class StatusDiffs
+{
+public:
+    /**
+     * Computes the status of the working directory of \a repo against \a index with
+     * \a options, without reading \a index again.
+     *
+     * @throws LibQGit2::Exception
+     */
+    StatusDiffs(git_repository *repo, git_index *index, const git_status_options &options);
+
+    StatusDiffs(const StatusDiffs &other) = delete;
+    StatusDiffs &operator=(const StatusDiffs &rhs) = delete;
+
+    /**
+     * Returns the entries, which point into the diffs held by this object.
+     */
+    const QVector<git_status_entry> &entries() const;
+
+private:
+    QSharedPointer<git_diff> m_headToIndex;
+    QSharedPointer<git_diff> m_indexToWorkdir;
+    QVector<git_status_entry> m_entries;
+};
+
+}
+}
+
+#endif // LIBQGIT2_STATUSDIFFS_H
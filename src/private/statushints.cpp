@@ -0,0 +1,255 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "statushints.h"
+
+#include "qgitexception.h"
+#include "private/parallel.h"
+#include "private/strarray.h"
+#include "private/workdirfile.h"
+
+#include <QMutex>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <algorithm>
+#include <limits>
+#include <string.h>
+
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#endif
+
+namespace LibQGit2 {
+namespace internal {
+
+namespace {
+
+QSharedPointer<git_index> repositoryIndex(git_repository *repo)
+{
+    git_index *index = 0;
+    qGitThrow(git_repository_index(&index, repo));
+    QSharedPointer<git_index> guard(index, git_index_free);
+    // as git_status_list_new() does
+    qGitThrow(git_index_read(index, false));
+    return guard;
+}
+
+/**
+ * Appends the paths that differ between HEAD and \a index.
+ */
+void appendStagedPaths(git_repository *repo, git_index *index, QList<QByteArray> &paths)
+{
+    git_object *tree = 0;
+    const int error = git_revparse_single(&tree, repo, "HEAD^{tree}");
+    if (error == GIT_ENOTFOUND || error == GIT_EUNBORNBRANCH) {
+        // everything is staged
+        giterr_clear();
+    } else {
+        qGitThrow(error);
+    }
+    QSharedPointer<git_object> treeGuard(tree, git_object_free);
+
+    git_diff *diff = 0;
+    qGitThrow(git_diff_tree_to_index(&diff, repo, reinterpret_cast<git_tree*>(tree), index, NULL));
+    QSharedPointer<git_diff> diffGuard(diff, git_diff_free);
+
+    const size_t count = git_diff_num_deltas(diff);
+    for (size_t i = 0; i < count; ++i) {
+        const git_diff_delta *delta = git_diff_get_delta(diff, i);
+        paths.append(QByteArray(delta->new_file.path));
+        if (strcmp(delta->old_file.path, delta->new_file.path) != 0) {
+            paths.append(QByteArray(delta->old_file.path));
+        }
+    }
+}
+
+void appendConflictPaths(git_index *index, QList<QByteArray> &paths)
+{
+    if (git_index_has_conflicts(index)) {
+        const size_t entries = git_index_entrycount(index);
+        for (size_t i = 0; i < entries; ++i) {
+            const git_index_entry *entry = git_index_get_byindex(index, i);
+            if (git_index_entry_stage(entry) != 0) {
+                paths.append(QByteArray(entry->path));
+            }
+        }
+    }
+}
+
+}
+
+git_status_list *hintedStatus(git_repository *repo, const git_status_options &options, const QList<QByteArray> &changedPaths,
+                              bool allStaged)
+{
+    git_status_options opts = options;
+    git_status_list *status = 0;
+
+    // nothing to limit: the index alone or paths the caller already chose
+    if (opts.show == GIT_STATUS_SHOW_INDEX_ONLY || opts.pathspec.count > 0) {
+        qGitThrow(git_status_list_new(&status, repo, &opts));
+        return status;
+    }
+
+    QList<QByteArray> paths(changedPaths);
+    if (allStaged) {
+        const QSharedPointer<git_index> index = repositoryIndex(repo);
+        if (opts.show != GIT_STATUS_SHOW_WORKDIR_ONLY) {
+            appendStagedPaths(repo, index.data(), paths);
+        }
+        appendConflictPaths(index.data(), paths);
+    }
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    if (paths.isEmpty()) {
+        // an empty list would match everything; .git is never reported
+        paths.append(".git");
+    }
+
+    StrArray pathspec(paths);
+    opts.pathspec = pathspec.data();
+    opts.flags |= GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH;
+    qGitThrow(git_status_list_new(&status, repo, &opts));
+    return status;
+}
+
+#ifndef Q_OS_UNIX
+
+bool scanWorkdir(git_repository *, int, QList<QByteArray> &)
+{
+    return false;
+}
+
+#else
+
+bool scanWorkdir(git_repository *repo, int threads, QList<QByteArray> &paths)
+{
+    if (git_repository_is_bare(repo)) {
+        throw Exception("Repository::parallelStatus(): the repository has no working directory");
+    }
+
+    const QSharedPointer<git_index> index = repositoryIndex(repo);
+    const QByteArray workdir(git_repository_workdir(repo));
+    const bool trustMode = trustFileMode(repo);
+
+    git_index_time indexTime;
+    WorkdirFile indexFile;
+    const char *indexPath = git_index_path(index.data());
+    if (indexPath && indexFile.stat(indexPath, true)) {
+        indexTime = indexFile.mtime;
+    } else {
+        indexTime.seconds = std::numeric_limits<qint32>::min();
+        indexTime.nanoseconds = 0;
+    }
+
+    // the paths point into the index, which is not modified while they are used
+    QVector<const git_index_entry*> entries;
+    QSet<QByteArray> files;
+    QSet<QByteArray> dirs;
+    dirs.insert(QByteArray(""));
+    const size_t count = git_index_entrycount(index.data());
+    entries.reserve(int(count));
+    files.reserve(int(count));
+    for (size_t i = 0; i < count; ++i) {
+        const git_index_entry *entry = git_index_get_byindex(index.data(), i);
+        const int length = int(strlen(entry->path));
+        files.insert(QByteArray::fromRawData(entry->path, length));
+        for (const char *slash = strchr(entry->path, '/'); slash; slash = strchr(slash + 1, '/')) {
+            dirs.insert(QByteArray::fromRawData(entry->path, int(slash - entry->path)));
+        }
+        // conflicts are added by hintedStatus()
+        if (git_index_entry_stage(entry) == 0) {
+            entries.append(entry);
+        }
+    }
+
+    QMutex mutex;
+
+    // the tracked files that may have changed...
+    parallelFor(entries.size(), threads, [&](int begin, int end) {
+        QList<QByteArray> found;
+        QByteArray path(workdir);
+        WorkdirFile file;
+        for (int i = begin; i < end; ++i) {
+            const git_index_entry *entry = entries.at(i);
+            path.resize(workdir.size());
+            path.append(entry->path);
+            // gitlinks are left to libgit2, which checks the submodule
+            if (entry->mode == GIT_FILEMODE_COMMIT
+                    || !file.stat(path.constData(), trustMode, entry->mode) || file.mode == 0
+                    || !file.matches(entry) || WorkdirFile::isRacy(entry->mtime, indexTime)) {
+                found.append(QByteArray(entry->path));
+            }
+        }
+        QMutexLocker locker(&mutex);
+        paths.append(found);
+    });
+
+    // ...and what is new in the tracked directories
+    const QVector<QByteArray> dirList = dirs.toList().toVector();
+    const QSet<QByteArray> &trackedFiles = files;
+    const QSet<QByteArray> &trackedDirs = dirs;
+    parallelFor(dirList.size(), threads, [&](int begin, int end) {
+        QList<QByteArray> found;
+        QByteArray path;
+        for (int i = begin; i < end; ++i) {
+            const QByteArray &dir = dirList.at(i);
+            path = workdir + dir;
+            QSharedPointer<DIR> handle(opendir(path.constData()), closedir);
+            if (!handle) {
+                // gone or replaced by a file: its entries were found above
+                continue;
+            }
+
+            while (const struct dirent *child = readdir(handle.data())) {
+                const char *name = child->d_name;
+                if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0
+                        || (dir.isEmpty() && strcmp(name, ".git") == 0)) {
+                    continue;
+                }
+
+                const QByteArray childPath = dir.isEmpty() ? QByteArray(name) : dir + '/' + name;
+                if (trackedDirs.contains(childPath)) {
+                    bool isDir = child->d_type == DT_DIR;
+                    if (child->d_type == DT_UNKNOWN) {
+                        WorkdirFile file;
+                        isDir = file.stat((workdir + childPath).constData(), true) && file.mode == 0;
+                    }
+                    // a file replaced a tracked directory
+                    if (!isDir) {
+                        found.append(childPath);
+                    }
+                } else if (!trackedFiles.contains(childPath)) {
+                    // untracked, or an untracked directory as a whole
+                    found.append(childPath);
+                }
+            }
+        }
+        QMutexLocker locker(&mutex);
+        paths.append(found);
+    });
+
+    return true;
+}
+
+#endif
+
+}
+}
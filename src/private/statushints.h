@@ -0,0 +1,64 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_STATUSHINTS_H
+#define LIBQGIT2_STATUSHINTS_H
+
+#include "git2.h"
+
+#include <QByteArray>
+#include <QList>
+
+namespace LibQGit2 {
+namespace internal {
+
+/**
+ * Runs git_status_list_new() on \a repo, but only for \a changedPaths, which may name
+ * directories for everything below them. Both the comparison of HEAD with the index
+ * and the one of the index with the working directory are limited to those paths, so
+ * the cost depends on their number rather than on the size of the index.
+ *
+ * With \a allStaged, the paths that differ between HEAD and the index and the
+ * conflicted paths are included as well, which takes a full comparison of HEAD with
+ * the index. This is for \a changedPaths found by scanning the whole working directory.
+ *
+ * The paths are given to libgit2 as a literal path list, which lets its working
+ * directory iterator skip the directories that contain none of them.
+ *
+ * @throws LibQGit2::Exception
+ */
+git_status_list *hintedStatus(git_repository *repo, const git_status_options &options, const QList<QByteArray> &changedPaths,
+                              bool allStaged = false);
+
+/**
+ * Finds the paths of the working directory of \a repo that may differ from its index,
+ * using up to \a threads threads: the tracked files whose stat data doesn't match the
+ * index or that are racily clean, and the files and directories found in the tracked
+ * directories that are not tracked themselves. Untracked directories are reported as
+ * a whole, without being walked.
+ *
+ * @return false if there is no parallel implementation for this platform, in which
+ *         case \a paths is left empty and the whole working directory must be checked
+ * @throws LibQGit2::Exception
+ */
+bool scanWorkdir(git_repository *repo, int threads, QList<QByteArray> &paths);
+
+}
+}
+
+#endif // LIBQGIT2_STATUSHINTS_H
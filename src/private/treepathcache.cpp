@@ -0,0 +1,110 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "treepathcache.h"
+
+#include <QHash>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QWriteLocker>
+
+namespace LibQGit2 {
+namespace internal {
+
+namespace {
+
+struct Registry {
+    QReadWriteLock lock;
+    QHash<QByteArray, QSharedPointer<TreePathCache> > caches;
+};
+
+Q_GLOBAL_STATIC(Registry, registry)
+
+}
+
+TreePathCache::TreePathCache(int maxEntries)
+    : m_entries(maxEntries),
+      m_hits(0)
+{
+}
+
+QSharedPointer<TreePathCache> TreePathCache::find(git_repository *repo)
+{
+    Registry *r = registry();
+    QReadLocker lock(&r->lock);
+    if (r->caches.isEmpty()) {
+        return QSharedPointer<TreePathCache>();
+    }
+    return r->caches.value(QByteArray(git_repository_path(repo)));
+}
+
+void TreePathCache::setMaxEntries(git_repository *repo, int maxEntries)
+{
+    const QByteArray path(git_repository_path(repo));
+
+    Registry *r = registry();
+    QWriteLocker lock(&r->lock);
+    if (maxEntries > 0) {
+        r->caches.insert(path, QSharedPointer<TreePathCache>(new TreePathCache(maxEntries)));
+    } else {
+        r->caches.remove(path);
+    }
+}
+
+bool TreePathCache::lookup(const git_oid *tree, const QByteArray &path, git_oid *out)
+{
+    const QByteArray k = key(tree, path);
+
+    // QCache::object() updates the LRU order, so lookups need exclusive access too
+    QMutexLocker lock(&m_mutex);
+    const git_oid *entry = m_entries.object(k);
+    if (!entry) {
+        return false;
+    }
+    git_oid_cpy(out, entry);
+    ++m_hits;
+    return true;
+}
+
+void TreePathCache::insert(const git_oid *tree, const QByteArray &path, const git_oid *entry)
+{
+    git_oid *copy = new git_oid;
+    git_oid_cpy(copy, entry);
+    const QByteArray k = key(tree, path);
+
+    QMutexLocker lock(&m_mutex);
+    m_entries.insert(k, copy);
+}
+
+int TreePathCache::hits()
+{
+    QMutexLocker lock(&m_mutex);
+    return m_hits;
+}
+
+QByteArray TreePathCache::key(const git_oid *tree, const QByteArray &path)
+{
+    QByteArray k;
+    k.reserve(GIT_OID_RAWSZ + path.size());
+    k.append(reinterpret_cast<const char*>(tree->id), GIT_OID_RAWSZ).append(path);
+    return k;
+}
+
+}
+}
@@ -0,0 +1,78 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_TREEPATHCACHE_H
+#define LIBQGIT2_TREEPATHCACHE_H
+
+#include "git2.h"
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QSharedPointer>
+
+namespace LibQGit2 {
+namespace internal {
+
+/**
+ * Thread-safe LRU cache mapping a tree id and a path below it to the id of the
+ * entry found at that path.
+ *
+ * Trees are immutable, so entries never need invalidation; they are only evicted
+ * once the cache is full. Caches are registered per repository directory, so all
+ * the git_repository handles opened on the same repository share one.
+ */
+class TreePathCache
+{
+public:
+    explicit TreePathCache(int maxEntries);
+
+    TreePathCache(const TreePathCache &other) = delete;
+    TreePathCache &operator=(const TreePathCache &rhs) = delete;
+
+    /**
+     * Returns the cache registered for \a repo, or a null pointer if there is none.
+     */
+    static QSharedPointer<TreePathCache> find(git_repository *repo);
+
+    /**
+     * Registers a cache holding at most \a maxEntries for \a repo, replacing any
+     * existing one, or unregisters it if \a maxEntries is not positive.
+     */
+    static void setMaxEntries(git_repository *repo, int maxEntries);
+
+    bool lookup(const git_oid *tree, const QByteArray &path, git_oid *out);
+    void insert(const git_oid *tree, const QByteArray &path, const git_oid *entry);
+
+    /**
+     * Returns the number of successful lookups so far.
+     */
+    int hits();
+
+private:
+    static QByteArray key(const git_oid *tree, const QByteArray &path);
+
+    QMutex m_mutex;
+    QCache<QByteArray, git_oid> m_entries;
+    int m_hits;
+};
+
+}
+}
+
+#endif // LIBQGIT2_TREEPATHCACHE_H
@@ -0,0 +1,181 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "workdirfile.h"
+
+#include "qgitexception.h"
+#include "private/pathcodec.h"
+
+#include <QFile>
+
+#ifdef Q_OS_UNIX
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LibQGit2 {
+namespace internal {
+
+bool trustFileMode(git_repository *repo)
+{
+    git_config *config = 0;
+    qGitThrow(git_repository_config_snapshot(&config, repo));
+    int value = 1;
+    if (git_config_get_bool(&value, config, "core.filemode") < 0) {
+        giterr_clear();
+        value = 1;
+    }
+    git_config_free(config);
+    return value;
+}
+
+bool hasFilters(git_repository *repo, const char *path)
+{
+    git_filter_list *filters = 0;
+    qGitThrow(git_filter_list_load(&filters, repo, NULL, path, GIT_FILTER_TO_ODB, GIT_FILTER_DEFAULT));
+    git_filter_list_free(filters);
+    return filters != 0;
+}
+
+#ifdef Q_OS_UNIX
+
+namespace {
+
+Q_NORETURN void failFile(const char *path, const char *what)
+{
+    throw Exception(PathCodec::fromLibGit2(path) + ": " + what + ": " + QString::fromLocal8Bit(strerror(errno)));
+}
+
+#ifdef Q_OS_DARWIN
+inline long mtimeNsec(const struct stat &st) { return st.st_mtimespec.tv_nsec; }
+inline long ctimeNsec(const struct stat &st) { return st.st_ctimespec.tv_nsec; }
+#else
+inline long mtimeNsec(const struct stat &st) { return st.st_mtim.tv_nsec; }
+inline long ctimeNsec(const struct stat &st) { return st.st_ctim.tv_nsec; }
+#endif
+
+bool sameTime(const git_index_time &cached, const git_index_time &current)
+{
+    // libgit2 may be built without nanosecond support, in which case none is cached
+    return cached.seconds == current.seconds
+        && (cached.nanoseconds == 0 || cached.nanoseconds == current.nanoseconds);
+}
+
+}
+
+bool WorkdirFile::stat(const char *path, bool trustFileMode, quint32 indexedMode)
+{
+    struct stat st;
+    if (::lstat(path, &st) != 0) {
+        if (errno == ENOENT || errno == ENOTDIR) {
+            return false;
+        }
+        failFile(path, "lstat failed");
+    }
+
+    if (S_ISLNK(st.st_mode)) {
+        mode = GIT_FILEMODE_LINK;
+    } else if (!S_ISREG(st.st_mode)) {
+        mode = 0;
+    } else if (trustFileMode) {
+        mode = (st.st_mode & S_IXUSR) ? GIT_FILEMODE_BLOB_EXECUTABLE : GIT_FILEMODE_BLOB;
+    } else {
+        mode = indexedMode == GIT_FILEMODE_BLOB_EXECUTABLE ? GIT_FILEMODE_BLOB_EXECUTABLE : GIT_FILEMODE_BLOB;
+    }
+
+    mtime.seconds = st.st_mtime;
+    mtime.nanoseconds = mtimeNsec(st);
+    ctime.seconds = st.st_ctime;
+    ctime.nanoseconds = ctimeNsec(st);
+    dev = st.st_dev;
+    ino = st.st_ino;
+    uid = st.st_uid;
+    gid = st.st_gid;
+    size = quint32(st.st_size);
+    return true;
+}
+
+bool WorkdirFile::matches(const git_index_entry *entry) const
+{
+    return mode == entry->mode
+        && size == entry->file_size
+        && sameTime(entry->mtime, mtime)
+        && sameTime(entry->ctime, ctime)
+        && (entry->ino == 0 || entry->ino == ino);
+}
+
+bool WorkdirFile::isRacy(const git_index_time &modified, const git_index_time &time)
+{
+    if (modified.seconds != time.seconds) {
+        return modified.seconds > time.seconds;
+    }
+    return modified.nanoseconds == 0 || modified.nanoseconds >= time.nanoseconds;
+}
+
+void WorkdirFile::hash(const char *path, git_oid *out) const
+{
+    if (mode != GIT_FILEMODE_LINK) {
+        qGitThrow(git_odb_hashfile(out, path, GIT_OBJ_BLOB));
+        return;
+    }
+
+    const QByteArray target = read(path);
+    qGitThrow(git_odb_hash(out, target.constData(), size_t(target.size()), GIT_OBJ_BLOB));
+}
+
+QByteArray WorkdirFile::read(const char *path) const
+{
+    if (mode == GIT_FILEMODE_LINK) {
+        QByteArray target(int(size) + 1, Qt::Uninitialized);
+        const ssize_t length = ::readlink(path, target.data(), target.size());
+        if (length < 0) {
+            failFile(path, "readlink failed");
+        }
+        target.truncate(int(length));
+        return target;
+    }
+
+    QFile file(QFile::decodeName(path));
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw Exception(PathCodec::fromLibGit2(path) + ": " + file.errorString());
+    }
+    QByteArray content = file.readAll();
+    if (file.error() != QFileDevice::NoError) {
+        throw Exception(PathCodec::fromLibGit2(path) + ": " + file.errorString());
+    }
+    return content;
+}
+
+void WorkdirFile::copyTo(git_index_entry &entry) const
+{
+    entry.mode = mode;
+    entry.mtime = mtime;
+    entry.ctime = ctime;
+    entry.dev = dev;
+    entry.ino = ino;
+    entry.uid = uid;
+    entry.gid = gid;
+    entry.file_size = size;
+}
+
+#endif
+
+}
+}
@@ -0,0 +1,109 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_WORKDIRFILE_H
+#define LIBQGIT2_WORKDIRFILE_H
+
+#include "git2.h"
+
+#include <QByteArray>
+
+namespace LibQGit2 {
+namespace internal {
+
+/**
+ * Reads whether the executable bit of files is meaningful in \a repo, i.e. the
+ * value of core.filemode.
+ */
+bool trustFileMode(git_repository *repo);
+
+/**
+ * Returns true if filters, e.g. CRLF conversion, apply to the file at \a path when
+ * it is stored in the object database. Reads the attributes of \a repo, so it must
+ * not be called from several threads.
+ *
+ * @throws LibQGit2::Exception
+ */
+bool hasFilters(git_repository *repo, const char *path);
+
+#ifdef Q_OS_UNIX
+
+/**
+ * The stat data of a file of the working directory, as recorded in index entries.
+ *
+ * Filling it only involves thread-safe system calls, so it can be done for many
+ * files from several threads.
+ */
+struct WorkdirFile {
+    quint32 mode;   ///< the git file mode; 0 if neither a regular file nor a symlink
+    git_index_time mtime;
+    git_index_time ctime;
+    quint32 dev;
+    quint32 ino;
+    quint32 uid;
+    quint32 gid;
+    quint32 size;
+
+    /**
+     * lstat()s \a path. Without \a trustFileMode, regular files keep the executable
+     * bit of \a indexedMode.
+     *
+     * @return false if there is no such file
+     * @throws LibQGit2::Exception on other errors
+     */
+    bool stat(const char *path, bool trustFileMode, quint32 indexedMode = 0);
+
+    /**
+     * Returns true if this stat data is the same as the one cached in \a entry.
+     */
+    bool matches(const git_index_entry *entry) const;
+
+    /**
+     * Returns true if the file was modified at or after \a time, so that another
+     * modification at the same time could go unnoticed.
+     */
+    static bool isRacy(const git_index_time &modified, const git_index_time &time);
+
+    /**
+     * Computes the id of the blob for the file at \a path, without applying any
+     * filter. Symbolic links are hashed from their target.
+     *
+     * @throws LibQGit2::Exception
+     */
+    void hash(const char *path, git_oid *out) const;
+
+    /**
+     * Reads the content of the blob for the file at \a path, without applying any
+     * filter: the target of symbolic links, the data of regular files.
+     *
+     * @throws LibQGit2::Exception
+     */
+    QByteArray read(const char *path) const;
+
+    /**
+     * Stores this stat data in \a entry.
+     */
+    void copyTo(git_index_entry &entry) const;
+};
+
+#endif
+
+}
+}
+
+#endif // LIBQGIT2_WORKDIRFILE_H
@@ -0,0 +1,72 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_CHANGEHINTPROVIDER_H
+#define LIBQGIT2_CHANGEHINTPROVIDER_H
+
+#include <QtCore/QStringList>
+
+#include "libqgit2_config.h"
+
+namespace LibQGit2
+{
+
+/**
+ * @brief Interface for the sources of the paths that changed in a working directory.
+ *
+ * A ChangeHintProvider tells Repository::status() which paths of the working
+ * directory may have changed since its previous call, e.g. from the events of a file
+ * system monitor, so that only those paths are checked instead of the whole working
+ * directory. This is the equivalent of Git's fsmonitor hook.
+ *
+ * The provider only has to report what changed since the previous call: each
+ * Repository remembers, per provider, the paths that its previous status found not
+ * current, untracked directories included, and checks them again until they are. A
+ * new untracked file is found only if the provider reports it or one of its parent
+ * directories. As the comparison of HEAD with the index is limited to the same paths,
+ * the provider must also report the paths that a change of the index or of HEAD may
+ * have affected, or return false.
+ *
+ * @ingroup LibQGit2
+ * @{
+ */
+class LIBQGIT2_EXPORT ChangeHintProvider
+{
+public:
+    virtual ~ChangeHintProvider();
+
+    /**
+     * Gets the paths that may have changed since the previous call.
+     *
+     * The paths are relative to the working directory. A directory stands for itself
+     * and everything under it, e.g. a directory that was created or moved in.
+     * Reporting unchanged paths is harmless; missing a changed one hides its change.
+     *
+     * @param paths receives the changed paths
+     * @return false if the provider cannot tell what changed, e.g. on its first call,
+     *         after its event queue overflowed or after the index or HEAD changed, in
+     *         which case the whole working directory is checked
+     */
+    virtual bool changedPaths(QStringList &paths) = 0;
+};
+
+/** @} */
+
+}
+
+#endif // LIBQGIT2_CHANGEHINTPROVIDER_H
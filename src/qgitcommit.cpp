@@ -26,6 +26,7 @@
 #include "qgitexception.h"
 
 #include "private/pathcodec.h"
+#include "private/treepathcache.h"
 
 namespace LibQGit2
 {
@@ -88,6 +89,43 @@ Tree Commit::tree() const
     return Tree(tree);
 }
 
+Blob Commit::blobAtPath(const QString& path) const
+{
+    git_repository *repo = git_commit_owner(data());
+    const git_oid *treeId = git_commit_tree_id(data());
+    const QByteArray encodedPath = PathCodec::toLibGit2(path);
+
+    QSharedPointer<internal::TreePathCache> cache = internal::TreePathCache::find(repo);
+    git_oid blobId;
+    if (!cache || !cache->lookup(treeId, encodedPath, &blobId)) {
+        git_tree *tree = 0;
+        qGitThrow(git_tree_lookup(&tree, repo, treeId));
+        QSharedPointer<git_tree> treeRef(tree, git_tree_free);
+
+        git_tree_entry *entry = 0;
+        int err = git_tree_entry_bypath(&entry, tree, encodedPath);
+        if (err == GIT_ENOTFOUND) {
+            giterr_clear();
+            return Blob();
+        }
+        qGitThrow(err);
+        QSharedPointer<git_tree_entry> entryRef(entry, git_tree_entry_free);
+
+        if (git_tree_entry_type(entry) != GIT_OBJ_BLOB) {
+            return Blob();
+        }
+        git_oid_cpy(&blobId, git_tree_entry_id(entry));
+
+        if (cache) {
+            cache->insert(treeId, encodedPath, &blobId);
+        }
+    }
+
+    git_blob *blob = 0;
+    qGitThrow(git_blob_lookup(&blob, repo, &blobId));
+    return Blob(blob);
+}
+
 unsigned int Commit::parentCount() const
 {
     return git_commit_parentcount(data());
@@ -21,6 +21,7 @@
 #ifndef LIBQGIT2_COMMIT_H
 #define LIBQGIT2_COMMIT_H
 
+#include "qgitblob.h"
 #include "qgitobject.h"
 #include "qgittree.h"
 #include "qgitsignature.h"
@@ -118,6 +119,18 @@ namespace LibQGit2
              */
             Tree tree() const;
 
+            /**
+             * Get the blob at \a path in the tree of this commit.
+             *
+             * This avoids creating objects for the intermediate trees, and uses the cache
+             * enabled by Repository::setTreePathCacheSize() if there is one.
+             *
+             * @param path the path of the file relative to the root of the tree
+             * @return the blob; a null Blob if \a path does not exist or isn't a file
+             * @throws Exception
+             */
+            Blob blobAtPath(const QString& path) const;
+
             /**
              * Get the number of parents of this commit
              */
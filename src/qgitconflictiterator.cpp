@@ -0,0 +1,109 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "qgitconflictiterator.h"
+#include "qgitindex.h"
+#include "qgitexception.h"
+
+#include "private/pathcodec.h"
+
+namespace LibQGit2
+{
+
+struct ConflictIterator::Private {
+    Private(const Index &index, git_index_conflict_iterator *iterator)
+        : m_index(index),
+          m_iterator(iterator),
+          m_ancestor(0),
+          m_ours(0),
+          m_theirs(0)
+    {
+    }
+
+    ~Private()
+    {
+        git_index_conflict_iterator_free(m_iterator);
+    }
+
+    bool next()
+    {
+        int error = git_index_conflict_next(&m_ancestor, &m_ours, &m_theirs, m_iterator);
+        if (error == GIT_ITEROVER) {
+            giterr_clear();
+            m_ancestor = m_ours = m_theirs = 0;
+            return false;
+        }
+        qGitThrow(error);
+        return true;
+    }
+
+    const char *path() const
+    {
+        const git_index_entry *entry = m_ours ? m_ours : m_theirs ? m_theirs : m_ancestor;
+        if (!entry) {
+            throw Exception("ConflictIterator: no current conflict, next() must return true first");
+        }
+        return entry->path;
+    }
+
+    // keeps the entries alive
+    Index m_index;
+    git_index_conflict_iterator *m_iterator;
+    const git_index_entry *m_ancestor;
+    const git_index_entry *m_ours;
+    const git_index_entry *m_theirs;
+};
+
+ConflictIterator::ConflictIterator(const Index &index)
+{
+    git_index_conflict_iterator *iterator = 0;
+    qGitThrow(git_index_conflict_iterator_new(&iterator, index.data()));
+    d_ptr = QSharedPointer<Private>(new Private(index, iterator));
+}
+
+bool ConflictIterator::next()
+{
+    return d_ptr->next();
+}
+
+const char *ConflictIterator::rawPath() const
+{
+    return d_ptr->path();
+}
+
+QString ConflictIterator::path() const
+{
+    return PathCodec::fromLibGit2(rawPath());
+}
+
+IndexEntry ConflictIterator::ancestor() const
+{
+    return IndexEntry(d_ptr->m_ancestor);
+}
+
+IndexEntry ConflictIterator::ours() const
+{
+    return IndexEntry(d_ptr->m_ours);
+}
+
+IndexEntry ConflictIterator::theirs() const
+{
+    return IndexEntry(d_ptr->m_theirs);
+}
+
+}
@@ -0,0 +1,111 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_CONFLICTITERATOR_H
+#define LIBQGIT2_CONFLICTITERATOR_H
+
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+
+#include "git2.h"
+
+#include "libqgit2_config.h"
+#include "qgitindexentry.h"
+
+namespace LibQGit2
+{
+
+class Index;
+
+/**
+ * @brief Wrapper class for git_index_conflict_iterator.
+ *
+ * Enumerates the conflicts of an Index in path order, giving for each conflicted
+ * path its ancestor, our and their entries (stages 1, 2 and 3). A side is null,
+ * see IndexEntry::isNull(), if the path doesn't exist there, e.g. ancestor() for a
+ * file added on both sides.
+ *
+ * Usage:
+ * @code
+ * ConflictIterator it(index);
+ * while (it.next()) {
+ *     resolutions[it.path()] = resolve(it.ancestor(), it.ours(), it.theirs());
+ * }
+ * index.resolveConflicts(resolutions);
+ * @endcode
+ *
+ * The entries point into the index, so they are only valid until the index is
+ * modified. Copies of a ConflictIterator share the same position.
+ *
+ * @ingroup LibQGit2
+ * @{
+ */
+class LIBQGIT2_EXPORT ConflictIterator
+{
+public:
+    /**
+     * Creates an iterator over the conflicts of \a index.
+     *
+     * @throws LibQGit2::Exception
+     */
+    explicit ConflictIterator(const Index &index);
+
+    /**
+     * Moves to the next conflict. Must be called once before accessing the first one.
+     *
+     * @return false when there are no more conflicts
+     * @throws LibQGit2::Exception
+     */
+    bool next();
+
+    /**
+     * Returns the path of the current conflict. The string is only valid until
+     * next() is called.
+     */
+    const char *rawPath() const;
+
+    /**
+     * Returns the path of the current conflict.
+     */
+    QString path() const;
+
+    /**
+     * Returns the entry of the common ancestor (stage 1).
+     */
+    IndexEntry ancestor() const;
+
+    /**
+     * Returns our entry (stage 2).
+     */
+    IndexEntry ours() const;
+
+    /**
+     * Returns their entry (stage 3).
+     */
+    IndexEntry theirs() const;
+
+private:
+    struct Private;
+    QSharedPointer<Private> d_ptr;
+};
+
+/** @} */
+
+}
+
+#endif // LIBQGIT2_CONFLICTITERATOR_H
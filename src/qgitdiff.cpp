@@ -18,10 +18,86 @@
 
 #include "qgitdiff.h"
 #include "qgitdiffdelta.h"
+#include "qgitexception.h"
+
+#include <QBuffer>
+#include <QScopedArrayPointer>
+
+#include <cstring>
 
 namespace LibQGit2
 {
 
+namespace
+{
+
+/**
+ * Gathers the lines printed by git_diff_print() in a fixed size buffer
+ * and writes them to a device whenever the buffer is full.
+ */
+class PatchWriter
+{
+public:
+    explicit PatchWriter(QIODevice *device) :
+        m_device(device),
+        m_buffer(new char[BufferSize]),
+        m_used(0),
+        m_failed(false)
+    {
+    }
+
+    static int printCallback(const git_diff_delta *, const git_diff_hunk *, const git_diff_line *line, void *payload)
+    {
+        PatchWriter *writer = static_cast<PatchWriter*>(payload);
+        if (line->origin == GIT_DIFF_LINE_CONTEXT ||
+                line->origin == GIT_DIFF_LINE_ADDITION ||
+                line->origin == GIT_DIFF_LINE_DELETION) {
+            writer->append(&line->origin, 1);
+        }
+        writer->append(line->content, line->content_len);
+        return writer->m_failed ? -1 : 0;
+    }
+
+    bool flush()
+    {
+        if (!m_failed && m_used > 0) {
+            m_failed = m_device->write(m_buffer.data(), qint64(m_used)) != qint64(m_used);
+            m_used = 0;
+        }
+        return !m_failed;
+    }
+
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+private:
+    void append(const char *data, size_t length)
+    {
+        if (m_used + length > BufferSize) {
+            if (!flush()) {
+                return;
+            }
+            if (length > BufferSize) {
+                m_failed = m_device->write(data, qint64(length)) != qint64(length);
+                return;
+            }
+        }
+        std::memcpy(m_buffer.data() + m_used, data, length);
+        m_used += length;
+    }
+
+    static const size_t BufferSize = 64 * 1024;
+
+    QIODevice *m_device;
+    QScopedArrayPointer<char> m_buffer;
+    size_t m_used;
+    bool m_failed;
+};
+
+}
+
 Diff::Diff(git_diff *diff) :
     d(diff, git_diff_free)
 {
@@ -45,4 +121,30 @@ DiffDelta Diff::delta(size_t index) const
     return DiffDelta(delta);
 }
 
+void Diff::writePatch(QIODevice *device, Format format) const
+{
+    if (device == NULL || !device->isWritable()) {
+        throw Exception("Diff::writePatch(): the device is not open for writing");
+    }
+    if (d.isNull()) {
+        return;
+    }
+
+    PatchWriter writer(device);
+    const int error = git_diff_print(d.data(), git_diff_format_t(format), &PatchWriter::printCallback, &writer);
+    if (writer.failed() || !writer.flush()) {
+        throw Exception("Diff::writePatch(): " + device->errorString());
+    }
+    qGitThrow(error);
+}
+
+QByteArray Diff::toBuffer(Format format) const
+{
+    QByteArray text;
+    QBuffer buffer(&text);
+    buffer.open(QIODevice::WriteOnly);
+    writePatch(&buffer, format);
+    return text;
+}
+
 }
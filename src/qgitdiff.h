@@ -25,6 +25,8 @@
 
 #include "libqgit2_config.h"
 
+class QIODevice;
+
 namespace LibQGit2
 {
 
@@ -36,6 +38,17 @@ class DiffDelta;
 class LIBQGIT2_EXPORT Diff
 {
 public:
+    /**
+     * The text formats a Diff can be written in.
+     */
+    enum Format {
+        Patch = GIT_DIFF_FORMAT_PATCH,                ///< full `git diff' output
+        PatchHeader = GIT_DIFF_FORMAT_PATCH_HEADER,   ///< only the file headers of the patch
+        Raw = GIT_DIFF_FORMAT_RAW,                    ///< like `git diff --raw'
+        NameOnly = GIT_DIFF_FORMAT_NAME_ONLY,         ///< like `git diff --name-only'
+        NameStatus = GIT_DIFF_FORMAT_NAME_STATUS      ///< like `git diff --name-status'
+    };
+
     Diff(git_diff *diff = 0);
 
     /**
@@ -54,6 +67,28 @@ public:
      */
     DiffDelta delta(size_t index) const;
 
+    /**
+     * @brief Writes this \c Diff to \a device in the given \a format.
+     *
+     * The text is produced one line at a time and gathered in a fixed size buffer
+     * which is written to the device whenever it fills up, so the memory used
+     * doesn't depend on the size of the diff.
+     *
+     * @param device an open, writable device.
+     * @param format the text format to write.
+     * @throws LibQGit2::Exception if the diff can't be generated or the device fails.
+     */
+    void writePatch(QIODevice *device, Format format = Patch) const;
+
+    /**
+     * @brief Returns this \c Diff as text in the given \a format.
+     *
+     * Convenience for writePatch() when the whole text is needed in memory.
+     *
+     * @throws LibQGit2::Exception
+     */
+    QByteArray toBuffer(Format format = Patch) const;
+
 public:
     QSharedPointer<git_diff> d;
 };
@@ -17,6 +17,7 @@
  */
 
 #include "qgitdifffile.h"
+#include "qgitoid.h"
 
 #include "private/pathcodec.h"
 
@@ -26,9 +27,44 @@ DiffFile::DiffFile(const git_diff_file *diff) : m_diff_file(diff)
 {
 }
 
+bool DiffFile::isNull() const
+{
+    return m_diff_file == NULL;
+}
+
 QString DiffFile::path() const
 {
     return PathCodec::fromLibGit2(m_diff_file != NULL ? m_diff_file->path : "");
 }
 
+const char *DiffFile::rawPath() const
+{
+    return m_diff_file != NULL ? m_diff_file->path : NULL;
+}
+
+OId DiffFile::oid() const
+{
+    return OId(m_diff_file != NULL ? &m_diff_file->id : NULL);
+}
+
+qint64 DiffFile::size() const
+{
+    return m_diff_file != NULL ? qint64(m_diff_file->size) : 0;
+}
+
+unsigned int DiffFile::mode() const
+{
+    return m_diff_file != NULL ? m_diff_file->mode : 0;
+}
+
+DiffFile::Flags DiffFile::flags() const
+{
+    return m_diff_file != NULL ? Flags(QFlag(int(m_diff_file->flags))) : Flags();
+}
+
+bool DiffFile::isBinary() const
+{
+    return flags().testFlag(Binary);
+}
+
 }
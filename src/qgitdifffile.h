@@ -23,8 +23,12 @@
 
 #include "git2.h"
 
+#include <QtCore/QString>
+
 namespace LibQGit2 {
 
+class OId;
+
 /**
  * @brief Wrapper class for git_diff_file.
  *
@@ -34,17 +38,68 @@ namespace LibQGit2 {
 class LIBQGIT2_EXPORT DiffFile
 {
 public:
+    /**
+     * Flags describing what is known about a DiffFile.
+     */
+    enum Flag {
+        Binary = GIT_DIFF_FLAG_BINARY,          ///< the file is treated as binary data
+        NotBinary = GIT_DIFF_FLAG_NOT_BINARY,   ///< the file is treated as text data
+        ValidId = GIT_DIFF_FLAG_VALID_ID,       ///< the oid() of the file is known
+        Exists = GIT_DIFF_FLAG_EXISTS           ///< the file exists at this side of the delta
+    };
+    Q_DECLARE_FLAGS(Flags, Flag)
+
     DiffFile(const git_diff_file *diff);
 
+    /**
+     * Returns true if this DiffFile doesn't point to any file information.
+     */
+    bool isNull() const;
+
     /**
      * Returns the path of the file if it is known. Otherwise returns an empty string.
      */
     QString path() const;
 
+    /**
+     * Returns the path of the file as stored by libgit2, without any conversion.
+     *
+     * The returned pointer is only valid as long as the Diff it comes from exists.
+     * Returns NULL if this is a null DiffFile.
+     */
+    const char *rawPath() const;
+
+    /**
+     * Returns the id of the file's object. Only meaningful if flags() contain \c ValidId.
+     */
+    OId oid() const;
+
+    /**
+     * Returns the size of the file in bytes, or 0 if it is not known.
+     */
+    qint64 size() const;
+
+    /**
+     * Returns the UNIX file mode of the file, in the same form as TreeEntry::attributes().
+     */
+    unsigned int mode() const;
+
+    /**
+     * Returns the flags describing what is known about the file.
+     */
+    Flags flags() const;
+
+    /**
+     * Convenience for testing the \c Binary flag.
+     */
+    bool isBinary() const;
+
 private:
     const git_diff_file *m_diff_file;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(DiffFile::Flags)
+
 /** @} */
 
 }
@@ -25,7 +25,13 @@
 
 #include "qgitrepository.h"
 
+#include "private/conflictresolver.h"
+#include "private/indexadder.h"
+#include "private/indexrefresher.h"
 #include "private/pathcodec.h"
+#include "private/pathcompare.h"
+
+#include <algorithm>
 
 namespace LibQGit2
 {
@@ -59,6 +65,13 @@ OId Index::createTree()
     return oid;
 }
 
+OId Index::createTree(const Repository &repo)
+{
+    OId oid;
+    qGitThrow(git_index_write_tree_to(oid.data(), data(), repo.data()));
+    return oid;
+}
+
 void Index::clear()
 {
     qGitThrow(git_index_clear(data()));
@@ -74,9 +87,57 @@ void Index::write()
     qGitThrow(git_index_write(data()));
 }
 
+unsigned int Index::version() const
+{
+#if LIBGIT2_VER_MAJOR > 0 || LIBGIT2_VER_MINOR >= 26
+    return git_index_version(data());
+#else
+    throw Exception("Index::version(): requires libgit2 0.26 or later");
+#endif
+}
+
+void Index::setVersion(unsigned int version)
+{
+#if LIBGIT2_VER_MAJOR > 0 || LIBGIT2_VER_MINOR >= 26
+    qGitThrow(git_index_set_version(data(), version));
+#else
+    Q_UNUSED(version);
+    throw Exception("Index::setVersion(): requires libgit2 0.26 or later");
+#endif
+}
+
 int Index::find(const QString& path)
 {
-    return git_index_find(NULL, data(), PathCodec::toLibGit2(path));
+    size_t position;
+    if (git_index_find(&position, data(), PathCodec::toLibGit2(path)) < 0) {
+        giterr_clear();
+        return -1;
+    }
+    return int(position);
+}
+
+Index::Range Index::findPrefix(const QString& dir) const
+{
+    QByteArray prefix = PathCodec::toLibGit2(dir);
+    if (!prefix.isEmpty() && !prefix.endsWith('/')) {
+        prefix.append('/');
+    }
+    if (prefix.isEmpty() || d.isNull()) {
+        return Range(begin(), end());
+    }
+
+    // the entries are sorted the way git_index_find() searches them
+    const bool ignoreCase = git_index_caps(data()) & GIT_INDEXCAP_IGNORE_CASE;
+    const size_t length = size_t(prefix.size());
+    auto compare = [ignoreCase, length](const char *a, const char *b) {
+        return ignoreCase ? internal::compareIgnoringAsciiCase(a, b, length) : qstrncmp(a, b, uint(length));
+    };
+
+    const const_iterator first = std::lower_bound(begin(), end(), prefix.constData(),
+        [&compare](const IndexEntry &entry, const char *path) { return compare(entry.rawPath(), path) < 0; });
+    const const_iterator last = std::upper_bound(first, end(), prefix.constData(),
+        [&compare](const char *path, const IndexEntry &entry) { return compare(path, entry.rawPath()) < 0; });
+    return Range(first, last);
 }
 
 void Index::addByPath(const QString& path)
@@ -84,6 +145,18 @@ void Index::addByPath(const QString& path)
     qGitThrow(git_index_add_bypath(data(), PathCodec::toLibGit2(path)));
 }
 
+void Index::addByPaths(const QStringList& paths, int threads)
+{
+    internal::IndexAdder adder(data(), threads);
+    adder.add(paths);
+}
+
+void Index::addAll(const QStringList& pathspec, int threads)
+{
+    internal::IndexAdder adder(data(), threads);
+    adder.addAll(pathspec);
+}
+
 void Index::remove(const QString& path, int stage)
 {
     qGitThrow(git_index_remove(data(), PathCodec::toLibGit2(path), stage));
@@ -99,6 +172,12 @@ void Index::updateAll()
     qGitThrow(git_index_update_all(data(), NULL, NULL, NULL));
 }
 
+QStringList Index::refresh(const QStringList &paths, int threads)
+{
+    internal::IndexRefresher refresher(data(), threads);
+    return refresher.refresh(paths);
+}
+
 IndexEntry Index::getByIndex(int n) const
 {
     return IndexEntry(git_index_get_byindex(data(), n));
@@ -109,11 +188,36 @@ unsigned int Index::entryCount() const
     return git_index_entrycount(data());
 }
 
+IndexEntry Index::entryAt(git_index *index, size_t position)
+{
+    return IndexEntry(git_index_get_byindex(index, position));
+}
+
+Index::const_iterator Index::begin() const
+{
+    return const_iterator(data(), 0);
+}
+
+Index::const_iterator Index::end() const
+{
+    return const_iterator(data(), d.isNull() ? 0 : git_index_entrycount(data()));
+}
+
 bool Index::hasConflicts() const
 {
     return !d.isNull() && git_index_has_conflicts(d.data());
 }
 
+void Index::resolveConflicts(const QMap<QString, OId>& resolutions)
+{
+    internal::resolveConflicts(data(), git_index_owner(data()), resolutions);
+}
+
+void Index::resolveConflicts(const QMap<QString, OId>& resolutions, const Repository &repo)
+{
+    internal::resolveConflicts(data(), repo.data(), resolutions);
+}
+
 git_index* Index::data() const
 {
     return d.data();
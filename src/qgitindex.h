@@ -21,17 +21,20 @@
 #ifndef LIBQGIT2_INDEX_H
 #define LIBQGIT2_INDEX_H
 
+#include <QtCore/QMap>
 #include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
 
 #include "git2.h"
 
 #include "libqgit2_config.h"
+#include "qgitindexentry.h"
+#include "qgitlistiterator.h"
 
 namespace LibQGit2
 {
     class OId;
     class Repository;
-    class IndexEntry;
 
     /**
      * @brief Wrapper class for git_index.
@@ -42,7 +45,36 @@ namespace LibQGit2
      */
     class LIBQGIT2_EXPORT Index
     {
+        private:
+            static IndexEntry entryAt(git_index *index, size_t position);
+
         public:
+            /**
+             * @brief Iterates over the entries of an Index, in path order.
+             *
+             * Dereferencing it returns an IndexEntry that points to the entry in the
+             * index, so iterating allocates nothing. Iterators are invalidated when
+             * entries are added to or removed from the index.
+             */
+            typedef ListIterator<git_index *, IndexEntry, &Index::entryAt> const_iterator;
+
+            /**
+             * @brief A range of consecutive entries of an Index, usable in a range-for.
+             */
+            class Range
+            {
+                public:
+                    Range(const const_iterator &begin, const const_iterator &end) : m_begin(begin), m_end(end) {}
+
+                    const_iterator begin() const { return m_begin; }
+                    const_iterator end() const { return m_end; }
+                    bool isEmpty() const { return m_begin == m_end; }
+                    int size() const { return int(m_end - m_begin); }
+
+                private:
+                    const_iterator m_begin;
+                    const_iterator m_end;
+            };
 
             /**
              * Creates a Index that points to 'index'. The pointer 'index' becomes managed by
@@ -83,6 +115,16 @@ namespace LibQGit2
              */
             OId createTree();
 
+            /**
+             * Create a new tree object from the index in the given repository
+             *
+             * Unlike createTree(), this also works for indexes that are not backed
+             * by a repository, e.g. those created in memory by Repository::mergeTrees().
+             *
+             * @throws LibQGit2::Exception
+             */
+            OId createTree(const Repository &repo);
+
             /**
              * Clear the contents (all the entries) of an index object.
              * This clears the index object in memory; changes must be manually
@@ -115,10 +157,42 @@ namespace LibQGit2
              * Write an existing index object from memory back to disk
              * using an atomic file lock.
              *
+             * The whole index file is rewritten, in the format given by version().
+             * libgit2 can neither read nor write a split index, nor maintain the
+             * untracked cache: an untracked cache present in the file is dropped and Git
+             * rebuilds it on its next status, as configured by core.untrackedCache.
+             * To make frequent writes of a large index cheaper, use setVersion() to
+             * write it in version 4, whose path compression makes the file much smaller.
+             *
              * @throws LibQGit2::Exception
              */
             void write();
 
+            /**
+             * Get the version of the on-disk format used when writing the index.
+             *
+             * Requires libgit2 0.26 or later.
+             *
+             * @return 2, 3 or 4
+             * @throws LibQGit2::Exception
+             */
+            unsigned int version() const;
+
+            /**
+             * Set the version of the on-disk format to use for the next write().
+             *
+             * Version 3 adds extended flags to version 2, which libgit2 uses
+             * automatically when needed. Version 4 compresses each path against the
+             * previous one, which usually makes the index file half as large or less,
+             * and is understood by Git 1.8 and later.
+             *
+             * Requires libgit2 0.26 or later.
+             *
+             * @param version 2, 3 or 4
+             * @throws LibQGit2::Exception
+             */
+            void setVersion(unsigned int version);
+
             /**
              * Find the first index of any entires which point to given
              * path in the Git index.
@@ -128,6 +202,20 @@ namespace LibQGit2
              */
             int find(const QString& path);
 
+            /**
+             * Find all the entries whose path is in the directory \a dir or one of its
+             * subdirectories, e.g. all the entries under "src/module".
+             *
+             * The entries of an index are sorted by path, so they are found with a binary
+             * search in O(log n) and returned as a range of consecutive entries, including
+             * those of conflicts.
+             *
+             * @param dir the directory, relative to the working directory and with or
+             *        without a trailing slash; all the entries if empty
+             * @return the entries in the directory, in path order
+             */
+            Range findPrefix(const QString& dir) const;
+
             /**
              * Add or update an index entry from a file in disk.
              *
@@ -136,6 +224,36 @@ namespace LibQGit2
              */
             void addByPath(const QString& path);
 
+            /**
+             * Add or update the index entries for many files in disk at once.
+             *
+             * This is equivalent to calling addByPath() for each path, but the files are
+             * read and their blob ids computed from several threads, and the blobs missing
+             * from the object database are written in one pass, each distinct content
+             * once. The entries are then inserted one at a time, in path order, since
+             * libgit2 has no bulk insertion into an existing index.
+             *
+             * @param paths the filenames to add, relative to the working directory
+             * @param threads the number of threads to use; QThread::idealThreadCount() if
+             *        not positive
+             * @throws LibQGit2::Exception
+             */
+            void addByPaths(const QStringList& paths, int threads = 0);
+
+            /**
+             * Add or update the index entries for all the files matching \a pathspec, and
+             * remove the entries of the files that were deleted, like `git add -A`.
+             *
+             * Untracked files are added unless they are ignored. The files are added as
+             * with addByPaths().
+             *
+             * @param pathspec pathspec limiting the files to add; all of them if empty
+             * @param threads the number of threads to use; QThread::idealThreadCount() if
+             *        not positive
+             * @throws LibQGit2::Exception
+             */
+            void addAll(const QStringList& pathspec = QStringList(), int threads = 0);
+
             /**
              * Remove an entry from the index given the path
              *
@@ -162,6 +280,29 @@ namespace LibQGit2
              */
             void updateAll();
 
+            /**
+             * Update the index entries matching \a paths to match the working directory,
+             * like updateAll(), spreading the work over several threads.
+             *
+             * The files are lstat'ed in parallel and compared with the stat data cached in
+             * the index; only the files whose stat data differs or that are racily clean are
+             * hashed, also in parallel unless a filter (e.g. CRLF conversion) applies to
+             * them. The blobs of modified files are written to the object database and the
+             * index is updated once all the files have been checked, from the calling thread.
+             * Entries whose files are gone are removed. The stat data of unchanged files is
+             * refreshed too, so they won't be hashed again.
+             *
+             * The changes are made in memory; call write() to save them.
+             *
+             * @param paths pathspec limiting the entries to refresh; all of them if empty
+             * @param threads the number of threads to use; QThread::idealThreadCount() if
+             *        not positive
+             * @return the paths of the entries whose content or mode changed, or that were
+             *         removed
+             * @throws LibQGit2::Exception
+             */
+            QStringList refresh(const QStringList &paths = QStringList(), int threads = 0);
+
             /**
              * Get a pointer to one of the entries in the index
              *
@@ -180,6 +321,16 @@ namespace LibQGit2
              */
             unsigned int entryCount() const;
 
+            /**
+             * Returns an iterator pointing to the first entry of the index.
+             */
+            const_iterator begin() const;
+
+            /**
+             * Returns an iterator pointing past the last entry of the index.
+             */
+            const_iterator end() const;
+
             /**
              * Checks if this Index has conflicts.
              * If this is a null index it never has conflicts.
@@ -187,6 +338,38 @@ namespace LibQGit2
              */
             bool hasConflicts() const;
 
+            /**
+             * Resolves many conflicts at once.
+             *
+             * For each path of \a resolutions, the conflict entries (stages 1 to 3) are
+             * replaced with a stage 0 entry for the given blob, with the mode of our side
+             * if it has one, or the path is removed from the index if the blob id is
+             * invalid. As when adding a conflicted file, the stages are recorded as a
+             * resolve undo entry.
+             *
+             * All the resolutions are validated before the index is changed: the blobs
+             * are looked up in the repository owning the index. Use ConflictIterator to
+             * enumerate the conflicts.
+             *
+             * @param resolutions the blob for each conflicted path
+             * @throws LibQGit2::Exception, leaving the index untouched, if the index is not
+             *         backed by a repository, one of the paths is not conflicted or one of
+             *         the blobs doesn't exist
+             */
+            void resolveConflicts(const QMap<QString, OId>& resolutions);
+
+            /**
+             * Resolves many conflicts at once, looking the blobs up in the given repository.
+             *
+             * Unlike resolveConflicts(const QMap<QString, OId>&), this also works for
+             * indexes that are not backed by a repository, e.g. those created in memory by
+             * Repository::mergeTrees().
+             *
+             * @throws LibQGit2::Exception, leaving the index untouched, if one of the paths
+             *         is not conflicted or one of the blobs doesn't exist in \a repo
+             */
+            void resolveConflicts(const QMap<QString, OId>& resolutions, const Repository &repo);
+
             git_index* data() const;
             const git_index* constData() const;
 
@@ -40,16 +40,31 @@ IndexEntry::~IndexEntry()
 {
 }
 
+bool IndexEntry::isNull() const
+{
+    return d == 0;
+}
+
 OId IndexEntry::id() const
 {
     return OId(&d->id);
 }
 
+const git_oid *IndexEntry::rawOid() const
+{
+    return &d->id;
+}
+
 QString IndexEntry::path() const
 {
     return PathCodec::fromLibGit2(d->path);
 }
 
+const char *IndexEntry::rawPath() const
+{
+    return d->path;
+}
+
 qint64 IndexEntry::fileSize() const
 {
     return d->file_size;
@@ -59,6 +74,51 @@ int IndexEntry::stage() const {
     return git_index_entry_stage(d);
 }
 
+unsigned int IndexEntry::mode() const
+{
+    return d->mode;
+}
+
+const git_index_time &IndexEntry::mtime() const
+{
+    return d->mtime;
+}
+
+const git_index_time &IndexEntry::ctime() const
+{
+    return d->ctime;
+}
+
+unsigned int IndexEntry::dev() const
+{
+    return d->dev;
+}
+
+unsigned int IndexEntry::ino() const
+{
+    return d->ino;
+}
+
+unsigned int IndexEntry::uid() const
+{
+    return d->uid;
+}
+
+unsigned int IndexEntry::gid() const
+{
+    return d->gid;
+}
+
+unsigned int IndexEntry::flags() const
+{
+    return d->flags;
+}
+
+unsigned int IndexEntry::extendedFlags() const
+{
+    return d->flags_extended;
+}
+
 const git_index_entry *IndexEntry::data() const
 {
     return d;
@@ -54,16 +54,34 @@ namespace LibQGit2
              */
             ~IndexEntry();
 
+            /**
+             * Returns true if this entry doesn't point to any data, e.g. when it was
+             * obtained with an out of bounds position.
+             */
+            bool isNull() const;
+
             /**
              * Get the id of an index entry.
              */
             OId id() const;
 
+            /**
+             * Get the id of an index entry without copying it.
+             * The pointer is valid as long as the entry is in the index.
+             */
+            const git_oid *rawOid() const;
+
             /**
              * Get the path of the index entry, represented by a string
              */
             QString path() const;
 
+            /**
+             * Get the path of the index entry as stored in the index, without any
+             * conversion. The pointer is valid as long as the entry is in the index.
+             */
+            const char *rawPath() const;
+
             /**
              * Get the size of the file
              */
@@ -78,6 +96,54 @@ namespace LibQGit2
              */
             int stage() const;
 
+            /**
+             * Get the UNIX file mode of the entry, in the same form as TreeEntry::attributes().
+             */
+            unsigned int mode() const;
+
+            /**
+             * Get the time of the last modification of the file's content, as recorded
+             * when the entry was last updated from the working directory.
+             */
+            const git_index_time &mtime() const;
+
+            /**
+             * Get the time of the last change of the file's metadata, as recorded
+             * when the entry was last updated from the working directory.
+             */
+            const git_index_time &ctime() const;
+
+            /**
+             * Get the device of the file, as recorded by the last stat().
+             */
+            unsigned int dev() const;
+
+            /**
+             * Get the inode number of the file, as recorded by the last stat().
+             */
+            unsigned int ino() const;
+
+            /**
+             * Get the user id of the file's owner, as recorded by the last stat().
+             */
+            unsigned int uid() const;
+
+            /**
+             * Get the group id of the file's owner, as recorded by the last stat().
+             */
+            unsigned int gid() const;
+
+            /**
+             * Get the flags of the entry: the stage and the length of the path,
+             * see \c git_indxentry_flag_t.
+             */
+            unsigned int flags() const;
+
+            /**
+             * Get the extended flags of the entry, see \c git_idxentry_extended_flag_t.
+             */
+            unsigned int extendedFlags() const;
+
             const git_index_entry *data() const;
 
         private:
@@ -21,6 +21,10 @@
 #include "qgitindexmodel.h"
 
 #include <qgitindexentry.h>
+#include <qgitoid.h>
+
+#include "private/pathcodec.h"
+#include "private/pathcompare.h"
 
 namespace LibQGit2
 {
@@ -28,6 +32,7 @@ namespace LibQGit2
 IndexModel::IndexModel(const Index& index, QObject *parent)
     : QAbstractListModel(parent)
     , m_index(index)
+    , m_rows(rows())
 {
 }
 
@@ -40,7 +45,7 @@ int IndexModel::rowCount(const QModelIndex& parent) const
     if (parent.isValid()) {
         return 0;
     } else {
-        return m_index.entryCount();
+        return m_rows.size();
     }
 }
 
@@ -49,15 +54,144 @@ QVariant IndexModel::data(const QModelIndex& index, int role) const
     if (index.parent().isValid())
         return QVariant();
 
-    if (index.column() != 0)
+    if (index.column() != 0 || index.row() < 0 || index.row() >= m_rows.size())
         return QVariant();
 
-    if (role == Qt::DisplayRole || role == Qt::EditRole) {
-        IndexEntry entry = m_index.getByIndex(index.row());
-        return entry.path();
-    } else {
+    const Row &row = m_rows.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+    case PathRole:
+        if (row.path.isNull()) {
+            row.path = PathCodec::fromLibGit2(row.rawPath);
+        }
+        return row.path;
+    case OIdRole:
+        return QString::fromLatin1(OId(&row.id).format());
+    case FileSizeRole:
+        return row.size;
+    case StageRole:
+        return int((row.flags & GIT_IDXENTRY_STAGEMASK) >> GIT_IDXENTRY_STAGESHIFT);
+    case ModeRole:
+        return row.mode;
+    case StatusRole:
+        if (row.flags & GIT_IDXENTRY_STAGEMASK) {
+            return Conflicted;
+        } else if (row.extendedFlags & GIT_IDXENTRY_INTENT_TO_ADD) {
+            return IntentToAdd;
+        } else if (row.extendedFlags & GIT_IDXENTRY_SKIP_WORKTREE) {
+            return SkipWorktree;
+        }
+        return Normal;
+    default:
         return QVariant();
     }
 }
 
+QHash<int, QByteArray> IndexModel::roleNames() const
+{
+    QHash<int, QByteArray> names = QAbstractListModel::roleNames();
+    names[PathRole] = "path";
+    names[OIdRole] = "oid";
+    names[FileSizeRole] = "fileSize";
+    names[StageRole] = "stage";
+    names[ModeRole] = "mode";
+    names[StatusRole] = "status";
+    return names;
+}
+
+void IndexModel::refresh(bool read)
+{
+    if (read && git_index_path(m_index.data()) != NULL) {
+        m_index.read(false);
+    }
+
+    // both lists are sorted as the index, so a single merge finds the differences
+    const QVector<Row> current = rows();
+    int row = 0, i = 0;
+    int firstChanged = -1;
+    auto flushChanged = [&]() {
+        if (firstChanged >= 0) {
+            emit dataChanged(createIndex(firstChanged, 0), createIndex(row - 1, 0));
+            firstChanged = -1;
+        }
+    };
+
+    while (row < m_rows.size() || i < current.size()) {
+        const int cmp = row == m_rows.size() ? 1
+                : i == current.size() ? -1 : compare(m_rows.at(row), current.at(i));
+
+        if (cmp < 0) {
+            flushChanged();
+            int last = row + 1;
+            while (last < m_rows.size() && (i == current.size() || compare(m_rows.at(last), current.at(i)) < 0)) {
+                ++last;
+            }
+            beginRemoveRows(QModelIndex(), row, last - 1);
+            m_rows.remove(row, last - row);
+            endRemoveRows();
+        } else if (cmp > 0) {
+            flushChanged();
+            int last = i + 1;
+            while (last < current.size() && (row == m_rows.size() || compare(current.at(last), m_rows.at(row)) < 0)) {
+                ++last;
+            }
+            beginInsertRows(QModelIndex(), row, row + last - i - 1);
+            m_rows.insert(row, last - i, Row());
+            for (; i < last; ++i) {
+                m_rows[row++] = current.at(i);
+            }
+            endInsertRows();
+        } else {
+            Row &old = m_rows[row];
+            const Row &now = current.at(i);
+            if (git_oid_equal(&old.id, &now.id) && old.size == now.size && old.mode == now.mode
+                    && old.flags == now.flags && old.extendedFlags == now.extendedFlags) {
+                flushChanged();
+            } else {
+                old = now;
+                if (firstChanged < 0) {
+                    firstChanged = row;
+                }
+            }
+            ++row;
+            ++i;
+        }
+    }
+    flushChanged();
+}
+
+QVector<IndexModel::Row> IndexModel::rows() const
+{
+    QVector<Row> rows;
+    if (!m_index.data()) {
+        return rows;
+    }
+    rows.reserve(m_index.entryCount());
+    for (const IndexEntry &entry : m_index) {
+        const git_index_entry *data = entry.data();
+        Row row;
+        row.rawPath = QByteArray(data->path);
+        row.id = data->id;
+        row.size = data->file_size;
+        row.mode = data->mode;
+        row.flags = data->flags;
+        row.extendedFlags = data->flags_extended;
+        rows.append(row);
+    }
+    return rows;
+}
+
+int IndexModel::compare(const Row &a, const Row &b) const
+{
+    // the order of the entries in the index
+    const bool ignoreCase = git_index_caps(m_index.data()) & GIT_INDEXCAP_IGNORE_CASE;
+    const int cmp = ignoreCase ? internal::compareIgnoringAsciiCase(a.rawPath.constData(), b.rawPath.constData())
+                               : qstrcmp(a.rawPath, b.rawPath);
+    if (cmp != 0) {
+        return cmp;
+    }
+    return int(a.flags & GIT_IDXENTRY_STAGEMASK) - int(b.flags & GIT_IDXENTRY_STAGEMASK);
+}
+
 }
@@ -24,15 +24,48 @@
 #include "qgitindex.h"
 
 #include <QAbstractListModel>
+#include <QVector>
 
 namespace LibQGit2
 {
 
+/**
+ * @brief A list model of the entries of an Index.
+ *
+ * The model keeps a snapshot of the entries, whose paths are only decoded when a view
+ * first asks for them, so that even very large indexes are cheap to show. Call
+ * refresh() after the index changed, e.g. to re-read it from disk: the model compares
+ * the new entries with its snapshot and only signals the rows that were inserted,
+ * removed or changed.
+ */
 class LIBQGIT2_EXPORT IndexModel : public QAbstractListModel
 {
     Q_OBJECT
 
 public:
+    /**
+     * The roles provided besides Qt::DisplayRole and Qt::EditRole, which both return
+     * the path of the entry.
+     */
+    enum Role {
+        PathRole = Qt::UserRole + 1,    ///< the path, as a QString
+        OIdRole,                        ///< the hexadecimal id of the blob, as a QString
+        FileSizeRole,                   ///< the size of the file, as a qint64
+        StageRole,                      ///< the stage, from 0 to 3
+        ModeRole,                       ///< the UNIX file mode, as TreeEntry::attributes()
+        StatusRole                      ///< the EntryStatus
+    };
+
+    /**
+     * The status of an entry, as recorded in the index.
+     */
+    enum EntryStatus {
+        Normal,
+        Conflicted,     ///< one side of a conflict, the stage is not 0
+        IntentToAdd,    ///< added with `git add -N`
+        SkipWorktree    ///< excluded from the working directory, e.g. by a sparse checkout
+    };
+
     explicit IndexModel(const Index& index, QObject *parent = 0);
     ~IndexModel();
 
@@ -40,8 +73,35 @@ public:
 
     QVariant data(const QModelIndex& index, int role) const;
 
+    QHash<int, QByteArray> roleNames() const;
+
+    /**
+     * Updates the model with the current entries of the index, emitting the row
+     * insertions, removals and data changes needed to go from the previous entries
+     * to the current ones.
+     *
+     * @param read if true the index is first re-read from disk if it was modified
+     *        there, see Index::read()
+     * @throws LibQGit2::Exception
+     */
+    void refresh(bool read = true);
+
 private:
+    struct Row {
+        QByteArray rawPath;
+        mutable QString path;   // decoded on demand
+        git_oid id;
+        qint64 size;
+        unsigned int mode;
+        unsigned int flags;
+        unsigned int extendedFlags;
+    };
+
+    QVector<Row> rows() const;
+    int compare(const Row &a, const Row &b) const;
+
     Index m_index;
+    QVector<Row> m_rows;
 };
 
 }
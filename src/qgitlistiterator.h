@@ -0,0 +1,98 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_LISTITERATOR_H
+#define LIBQGIT2_LISTITERATOR_H
+
+#include <cstddef>
+#include <iterator>
+
+namespace LibQGit2
+{
+
+/**
+ * @brief A random access iterator over a list whose entries are addressed by position.
+ *
+ * Dereferencing it returns the \a Value that \a At makes of the entry of \a List at
+ * the current position, usually a wrapper pointing to the entry, so iterating
+ * allocates nothing. As that value is a temporary, operator->() returns a proxy
+ * holding it.
+ *
+ * @ingroup LibQGit2
+ * @{
+ */
+template <typename List, typename Value, Value (*At)(List, size_t)>
+class ListIterator
+{
+public:
+    /**
+     * @brief Holds the value an iterator points to, for operator->().
+     */
+    class pointer
+    {
+    public:
+        explicit pointer(const Value &value) : m_value(value) {}
+        const Value *operator->() const { return &m_value; }
+
+    private:
+        Value m_value;
+    };
+
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef Value value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Value reference;
+
+    ListIterator() : m_list(), m_position(0) {}
+    ListIterator(List list, size_t position) : m_list(list), m_position(position) {}
+
+    Value operator*() const { return At(m_list, m_position); }
+    pointer operator->() const { return pointer(**this); }
+    Value operator[](difference_type n) const { return *(*this + n); }
+
+    /**
+     * Returns the position of the entry this iterator points to.
+     */
+    size_t position() const { return m_position; }
+
+    ListIterator &operator++() { ++m_position; return *this; }
+    ListIterator operator++(int) { ListIterator it(*this); ++m_position; return it; }
+    ListIterator &operator--() { --m_position; return *this; }
+    ListIterator operator--(int) { ListIterator it(*this); --m_position; return it; }
+    ListIterator &operator+=(difference_type n) { m_position += n; return *this; }
+    ListIterator &operator-=(difference_type n) { m_position -= n; return *this; }
+    ListIterator operator+(difference_type n) const { return ListIterator(m_list, m_position + n); }
+    ListIterator operator-(difference_type n) const { return ListIterator(m_list, m_position - n); }
+    difference_type operator-(const ListIterator &other) const { return difference_type(m_position) - difference_type(other.m_position); }
+
+    bool operator==(const ListIterator &other) const { return m_position == other.m_position && m_list == other.m_list; }
+    bool operator!=(const ListIterator &other) const { return !(*this == other); }
+    bool operator<(const ListIterator &other) const { return m_position < other.m_position; }
+    bool operator>(const ListIterator &other) const { return other < *this; }
+    bool operator<=(const ListIterator &other) const { return !(other < *this); }
+    bool operator>=(const ListIterator &other) const { return !(*this < other); }
+
+private:
+    List m_list;
+    size_t m_position;
+};
+
+/**@}*/
+}
+
+#endif // LIBQGIT2_LISTITERATOR_H
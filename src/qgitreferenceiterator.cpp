@@ -0,0 +1,120 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "qgitreferenceiterator.h"
+#include "qgitrepository.h"
+#include "qgitoid.h"
+#include "qgitexception.h"
+
+namespace LibQGit2
+{
+
+struct ReferenceIterator::Private {
+    Private(git_reference_iterator *iterator)
+        : m_iterator(iterator),
+          m_current(0)
+    {
+    }
+
+    ~Private()
+    {
+        git_reference_free(m_current);
+        git_reference_iterator_free(m_iterator);
+    }
+
+    bool next()
+    {
+        git_reference_free(m_current);
+        m_current = 0;
+
+        int error = git_reference_next(&m_current, m_iterator);
+        if (error == GIT_ITEROVER) {
+            giterr_clear();
+            return false;
+        }
+        qGitThrow(error);
+        return true;
+    }
+
+    const git_reference *current() const
+    {
+        if (!m_current) {
+            throw Exception("ReferenceIterator: no current reference, next() must return true first");
+        }
+        return m_current;
+    }
+
+private:
+    git_reference_iterator *m_iterator;
+    git_reference *m_current;
+};
+
+ReferenceIterator::ReferenceIterator(const Repository &repo, const QString &glob)
+{
+    git_reference_iterator *iterator = 0;
+    if (glob.isEmpty()) {
+        qGitThrow(git_reference_iterator_new(&iterator, repo.data()));
+    } else {
+        qGitThrow(git_reference_iterator_glob_new(&iterator, repo.data(), glob.toUtf8()));
+    }
+    d_ptr = QSharedPointer<Private>(new Private(iterator));
+}
+
+bool ReferenceIterator::next()
+{
+    return d_ptr->next();
+}
+
+const char *ReferenceIterator::rawName() const
+{
+    return git_reference_name(d_ptr->current());
+}
+
+QString ReferenceIterator::name() const
+{
+    return QString::fromUtf8(rawName());
+}
+
+bool ReferenceIterator::isSymbolic() const
+{
+    return git_reference_type(d_ptr->current()) == GIT_REF_SYMBOLIC;
+}
+
+const git_oid *ReferenceIterator::rawTarget() const
+{
+    return git_reference_target(d_ptr->current());
+}
+
+OId ReferenceIterator::target() const
+{
+    return OId(rawTarget());
+}
+
+const char *ReferenceIterator::rawSymbolicTarget() const
+{
+    return git_reference_symbolic_target(d_ptr->current());
+}
+
+Reference ReferenceIterator::reference() const
+{
+    git_reference *ref = 0;
+    qGitThrow(git_reference_dup(&ref, const_cast<git_reference*>(d_ptr->current())));
+    return Reference(ref);
+}
+
+}
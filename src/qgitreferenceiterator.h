@@ -0,0 +1,125 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_REFERENCEITERATOR_H
+#define LIBQGIT2_REFERENCEITERATOR_H
+
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+
+#include "git2.h"
+
+#include "libqgit2_config.h"
+#include "qgitref.h"
+
+namespace LibQGit2
+{
+
+class OId;
+class Repository;
+
+/**
+ * @brief Wrapper class for git_reference_iterator.
+ *
+ * Enumerates the references of a repository, optionally filtered by a glob, giving
+ * access to the name and target of each reference as it is read. This is much
+ * cheaper than Repository::listReferences() followed by a lookup per name, and the
+ * raw accessors don't convert anything to QString.
+ *
+ * Usage:
+ * @code
+ * ReferenceIterator it(repo, "refs/heads/*");
+ * while (it.next()) {
+ *     process(it.rawName(), it.rawTarget());
+ * }
+ * @endcode
+ *
+ * Copies of a ReferenceIterator share the same position.
+ *
+ * @ingroup LibQGit2
+ * @{
+ */
+class LIBQGIT2_EXPORT ReferenceIterator
+{
+public:
+    /**
+     * Creates an iterator over the references of \a repo whose names match \a glob,
+     * or over all of them if \a glob is empty.
+     *
+     * @throws LibQGit2::Exception
+     */
+    explicit ReferenceIterator(const Repository &repo, const QString &glob = QString());
+
+    /**
+     * Moves to the next reference. Must be called once before accessing the first one.
+     *
+     * @return false when there are no more references
+     * @throws LibQGit2::Exception
+     */
+    bool next();
+
+    /**
+     * Returns the full name of the current reference, e.g. "refs/heads/master". The
+     * string is only valid until next() is called.
+     */
+    const char *rawName() const;
+
+    /**
+     * Returns the full name of the current reference.
+     */
+    QString name() const;
+
+    /**
+     * Returns true if the current reference is symbolic.
+     */
+    bool isSymbolic() const;
+
+    /**
+     * Returns the id the current reference points to, or NULL if it is symbolic. The
+     * id is only valid until next() is called.
+     */
+    const git_oid *rawTarget() const;
+
+    /**
+     * Returns the id the current reference points to; an invalid OId if it is symbolic.
+     */
+    OId target() const;
+
+    /**
+     * Returns the name of the reference the current one points to if it is symbolic;
+     * NULL otherwise. The string is only valid until next() is called.
+     */
+    const char *rawSymbolicTarget() const;
+
+    /**
+     * Returns the current reference as a Reference object.
+     *
+     * @throws LibQGit2::Exception
+     */
+    Reference reference() const;
+
+private:
+    struct Private;
+    QSharedPointer<Private> d_ptr;
+};
+
+/** @} */
+
+}
+
+#endif // LIBQGIT2_REFERENCEITERATOR_H
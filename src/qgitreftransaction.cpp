@@ -0,0 +1,73 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "qgitreftransaction.h"
+#include "qgitrepository.h"
+#include "qgitoid.h"
+#include "qgitexception.h"
+
+namespace LibQGit2
+{
+
+RefTransaction::RefTransaction(const Repository &repo)
+{
+    git_transaction *tx = 0;
+    qGitThrow(git_transaction_new(&tx, repo.data()));
+    d = QSharedPointer<git_transaction>(tx, git_transaction_free);
+}
+
+void RefTransaction::lockRef(const QString &name)
+{
+    qGitThrow(git_transaction_lock_ref(data(), name.toUtf8()));
+}
+
+void RefTransaction::lockRefs(const QStringList &names)
+{
+    foreach (const QString &name, names) {
+        lockRef(name);
+    }
+}
+
+void RefTransaction::setTarget(const QString &name, const OId &oid, const QString &message, const Signature &signature)
+{
+    qGitThrow(git_transaction_set_target(data(), name.toUtf8(), oid.constData(), signature.data(),
+                                         message.isNull() ? NULL : message.toUtf8().constData()));
+}
+
+void RefTransaction::setSymbolicTarget(const QString &name, const QString &target, const QString &message, const Signature &signature)
+{
+    qGitThrow(git_transaction_set_symbolic_target(data(), name.toUtf8(), target.toUtf8(), signature.data(),
+                                                  message.isNull() ? NULL : message.toUtf8().constData()));
+}
+
+void RefTransaction::remove(const QString &name)
+{
+    qGitThrow(git_transaction_remove(data(), name.toUtf8()));
+}
+
+void RefTransaction::commit()
+{
+    qGitThrow(git_transaction_commit(data()));
+}
+
+git_transaction *RefTransaction::data() const
+{
+    return d.data();
+}
+
+}
@@ -0,0 +1,117 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_REFTRANSACTION_H
+#define LIBQGIT2_REFTRANSACTION_H
+
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "git2.h"
+
+#include "libqgit2_config.h"
+#include "qgitsignature.h"
+
+namespace LibQGit2
+{
+
+class OId;
+class Repository;
+
+/**
+ * @brief Wrapper class for git_transaction.
+ *
+ * Updates a set of references together: all of them are locked first, then the
+ * changes are queued, and they are all written when commit() is called. This avoids
+ * the lock and write round trip per reference that Repository::createRef() or
+ * Reference::setTarget() go through, and no other process sees a partial update
+ * while the references are locked.
+ *
+ * If the transaction is destroyed without being committed, the locks are released
+ * and nothing is changed.
+ *
+ * @ingroup LibQGit2
+ * @{
+ */
+class LIBQGIT2_EXPORT RefTransaction
+{
+public:
+    /**
+     * Creates an empty transaction on the references of \a repo.
+     *
+     * @throws LibQGit2::Exception
+     */
+    explicit RefTransaction(const Repository &repo);
+
+    /**
+     * Locks the reference \a name, which doesn't need to exist yet. A reference must be
+     * locked before any change to it can be queued.
+     *
+     * @throws LibQGit2::Exception if the reference is already locked, e.g. by another process
+     */
+    void lockRef(const QString &name);
+
+    /**
+     * Locks all the references in \a names.
+     *
+     * @throws LibQGit2::Exception
+     */
+    void lockRefs(const QStringList &names);
+
+    /**
+     * Makes the locked reference \a name point to \a oid, creating it if needed.
+     *
+     * @param message the reflog message; the default identity of the repository is
+     *        used unless a non-null \a signature is given
+     * @throws LibQGit2::Exception
+     */
+    void setTarget(const QString &name, const OId &oid, const QString &message = QString(), const Signature &signature = Signature());
+
+    /**
+     * Makes the locked reference \a name a symbolic reference to \a target.
+     *
+     * @throws LibQGit2::Exception
+     */
+    void setSymbolicTarget(const QString &name, const QString &target, const QString &message = QString(), const Signature &signature = Signature());
+
+    /**
+     * Deletes the locked reference \a name.
+     *
+     * @throws LibQGit2::Exception
+     */
+    void remove(const QString &name);
+
+    /**
+     * Writes all the queued changes and releases the locks.
+     *
+     * @throws LibQGit2::Exception
+     */
+    void commit();
+
+    git_transaction *data() const;
+
+private:
+    QSharedPointer<git_transaction> d;
+};
+
+/** @} */
+
+}
+
+#endif // LIBQGIT2_REFTRANSACTION_H
@@ -20,6 +20,9 @@
 
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
 #include <QtCore/QVector>
 
 #include "qgitrepository.h"
@@ -32,14 +35,40 @@
 #include "qgitremote.h"
 #include "qgitcredentials.h"
 #include "qgitdiff.h"
+#include "qgitchangehintprovider.h"
 #include "private/annotatedcommit.h"
 #include "private/buffer.h"
+#include "private/patchapplier.h"
 #include "private/pathcodec.h"
+#include "private/refsnapshot.h"
 #include "private/remotecallbacks.h"
+#include "private/statusdiffs.h"
+#include "private/statushints.h"
 #include "private/strarray.h"
+#include "private/treepathcache.h"
 
 namespace {
     void do_not_free(git_repository*) {}
+
+    /**
+     * Returns the index of \a cache. With StatCache::WriteIndex, \a updateFlag is added
+     * to \a flags so libgit2 records the stat data it verified and writes the index;
+     * otherwise the cache refreshed the stat data in memory when it loaded the index.
+     */
+    LibQGit2::Index prepareStatCache(const LibQGit2::StatCache &cache, unsigned int &flags, unsigned int updateFlag)
+    {
+        if (cache.updateMode() == LibQGit2::StatCache::WriteIndex) {
+            flags |= updateFlag;
+        }
+        return cache.index();
+    }
+
+    struct DiscoveryCache {
+        QMutex mutex;
+        QHash<QString, QString> paths;
+    };
+
+    Q_GLOBAL_STATIC(DiscoveryCache, discoveryCache)
 }
 
 namespace LibQGit2
@@ -52,6 +81,9 @@ public:
     typedef QSharedPointer<git_repository> ptr_type;
     ptr_type d;
     QMap<QString, Credentials> m_remote_credentials;
+    QSharedPointer<internal::RefSnapshot> m_refSnapshot;
+    // per provider, the paths that were not current in the previous hinted status
+    QHash<const ChangeHintProvider *, QStringList> m_pendingPaths;
     Repository &m_owner;
 
     Private(git_repository *repository, bool own, Repository &owner) :
@@ -63,6 +95,8 @@ public:
     Private(const Private &other, Repository &owner) :
         d(other.d),
         m_remote_credentials(other.m_remote_credentials),
+        m_refSnapshot(other.m_refSnapshot),
+        m_pendingPaths(other.m_pendingPaths),
         m_owner(owner)
     {
     }
@@ -83,9 +117,27 @@ public:
         setData(repo);
     }
 
+    void openWithoutSearch(const QString& path)
+    {
+        d.clear();
+        git_repository *repo = 0;
+        qGitThrow(git_repository_open_ext(&repo, PathCodec::toLibGit2(path), GIT_REPOSITORY_OPEN_NO_SEARCH, NULL));
+        setData(repo);
+    }
+
     void setData(git_repository *repo)
     {
         d = ptr_type(repo, git_repository_free);
+        m_pendingPaths.clear();
+        if (m_refSnapshot) {
+            enableRefSnapshot();
+        }
+    }
+
+    void enableRefSnapshot()
+    {
+        m_refSnapshot = QSharedPointer<internal::RefSnapshot>(
+                new internal::RefSnapshot(PathCodec::fromLibGit2(git_repository_path(safeData("setRefSnapshotEnabled")))));
     }
 
     git_repository* safeData(const char *funcName) const {
@@ -152,6 +204,46 @@ void Repository::discoverAndOpen(const QString &startPath,
     open(discover(startPath, acrossFs, ceilingDirs));
 }
 
+void Repository::discoverAndOpenCached(const QString &startPath,
+                                       bool acrossFs,
+                                       const QStringList &ceilingDirs)
+{
+    // a relative path depends on the current directory
+    const QString start = QDir::cleanPath(QFileInfo(startPath).absoluteFilePath());
+    const QString key = QString::number(acrossFs) + QChar(GIT_PATH_LIST_SEPARATOR)
+            + ceilingDirs.join(QChar(GIT_PATH_LIST_SEPARATOR)) + QChar('\0') + start;
+
+    DiscoveryCache *cache = discoveryCache();
+    QMutexLocker lock(&cache->mutex);
+    const QString cached = cache->paths.value(key);
+    lock.unlock();
+
+    if (!cached.isEmpty()) {
+        try {
+            d_ptr->openWithoutSearch(cached);
+            return;
+        } catch (const Exception&) {
+            // moved or deleted since it was discovered
+            lock.relock();
+            cache->paths.remove(key);
+            lock.unlock();
+        }
+    }
+
+    const QString path = discover(start, acrossFs, ceilingDirs);
+    d_ptr->openWithoutSearch(path);
+
+    lock.relock();
+    cache->paths.insert(key, path);
+}
+
+void Repository::clearDiscoveryCache()
+{
+    DiscoveryCache *cache = discoveryCache();
+    QMutexLocker lock(&cache->mutex);
+    cache->paths.clear();
+}
+
 Reference Repository::head() const
 {
     git_reference *ref = 0;
@@ -214,6 +306,10 @@ Reference Repository::lookupRef(const QString& name) const
 
 OId Repository::lookupRefOId(const QString& name) const
 {
+    if (d_ptr->m_refSnapshot) {
+        return d_ptr->m_refSnapshot->resolve(SAFE_DATA, name);
+    }
+
     git_oid oid;
     qGitThrow(git_reference_name_to_id(&oid, SAFE_DATA, PathCodec::toLibGit2(name)));
     return OId(&oid);
@@ -295,6 +391,81 @@ OId Repository::createCommit(const Tree& tree, const QList<Commit>& parents, con
     return oid;
 }
 
+namespace {
+
+typedef QList<QPair<QByteArray, OId> > TreeChanges;
+
+// Applies \a changes, keyed by paths relative to \a base, recursing only into the
+// subtrees they touch. Returns false without writing anything if the resulting
+// tree would be empty, unless \a keepEmpty is set.
+bool writeUpdatedTree(git_oid *out, git_repository *repo, const git_tree *base, const TreeChanges &changes, bool keepEmpty)
+{
+    git_treebuilder *bld = 0;
+    qGitThrow(git_treebuilder_new(&bld, repo, base));
+    QSharedPointer<git_treebuilder> builder(bld, git_treebuilder_free);
+
+    QMap<QByteArray, TreeChanges> subtrees;
+    foreach (const TreeChanges::value_type &change, changes) {
+        const int slash = change.first.indexOf('/');
+        if (slash == 0 || change.first.isEmpty()) {
+            throw Exception("Repository::updateTree(): invalid path");
+        }
+
+        if (slash > 0) {
+            subtrees[change.first.left(slash)].append(qMakePair(change.first.mid(slash + 1), change.second));
+            continue;
+        }
+
+        const git_tree_entry *existing = git_treebuilder_get(bld, change.first);
+        if (change.second.isValid()) {
+            git_filemode_t mode = GIT_FILEMODE_BLOB;
+            if (existing && git_tree_entry_type(existing) == GIT_OBJ_BLOB) {
+                mode = git_tree_entry_filemode(existing);
+            }
+            qGitThrow(git_treebuilder_insert(NULL, bld, change.first, change.second.constData(), mode));
+        } else if (existing) {
+            qGitThrow(git_treebuilder_remove(bld, change.first));
+        }
+    }
+
+    for (QMap<QByteArray, TreeChanges>::const_iterator it = subtrees.constBegin(); it != subtrees.constEnd(); ++it) {
+        const git_tree_entry *existing = git_treebuilder_get(bld, it.key());
+        git_tree *tree = 0;
+        if (existing && git_tree_entry_type(existing) == GIT_OBJ_TREE) {
+            qGitThrow(git_tree_lookup(&tree, repo, git_tree_entry_id(existing)));
+        }
+        QSharedPointer<git_tree> subtree(tree, git_tree_free);
+
+        git_oid oid;
+        if (writeUpdatedTree(&oid, repo, tree, it.value(), false)) {
+            qGitThrow(git_treebuilder_insert(NULL, bld, it.key(), &oid, GIT_FILEMODE_TREE));
+        } else if (tree) {
+            qGitThrow(git_treebuilder_remove(bld, it.key()));
+        }
+    }
+
+    if (!keepEmpty && git_treebuilder_entrycount(bld) == 0) {
+        return false;
+    }
+    qGitThrow(git_treebuilder_write(out, bld));
+    return true;
+}
+
+}
+
+OId Repository::updateTree(const Tree& base, const QMap<QString, OId>& changes) const
+{
+    TreeChanges encoded;
+    encoded.reserve(changes.size());
+    for (QMap<QString, OId>::const_iterator it = changes.constBegin(); it != changes.constEnd(); ++it) {
+        encoded.append(qMakePair(PathCodec::toLibGit2(it.key()), it.value()));
+    }
+
+    OId oid;
+    writeUpdatedTree(oid.data(), SAFE_DATA, base.constData(), encoded, true);
+    return oid;
+}
+
 OId Repository::createTag(const QString& name,
                                   const Object& target,
                                   bool overwrite)
@@ -374,6 +545,59 @@ QStringList Repository::listTags(const QString& pattern) const
     return list;
 }
 
+QList<Repository::TagInfo> Repository::listTagsPeeled(const QString& pattern) const
+{
+    static const char TagsPrefix[] = "refs/tags/";
+
+    git_repository *repo = SAFE_DATA;
+    git_reference_iterator *it = 0;
+    qGitThrow(git_reference_iterator_glob_new(&it, repo, QByteArray(TagsPrefix) + (pattern.isEmpty() ? QByteArray("*") : pattern.toUtf8())));
+    QSharedPointer<git_reference_iterator> iterator(it, git_reference_iterator_free);
+
+    git_odb *db = 0;
+    qGitThrow(git_repository_odb(&db, repo));
+    QSharedPointer<git_odb> odb(db, git_odb_free);
+
+    QList<TagInfo> tags;
+    git_reference *r = 0;
+    int err;
+    while ((err = git_reference_next(&r, it)) == 0) {
+        QSharedPointer<git_reference> ref(r, git_reference_free);
+        const git_oid *oid = git_reference_target(r);
+        if (!oid) {
+            continue;
+        }
+
+        TagInfo tag;
+        tag.name = QString::fromUtf8(git_reference_name(r) + sizeof(TagsPrefix) - 1);
+        tag.oid = OId(oid);
+
+        if (const git_oid *peeled = git_reference_target_peel(r)) {
+            // recorded in packed-refs
+            tag.target = OId(peeled);
+        } else {
+            size_t size;
+            git_otype type;
+            qGitThrow(git_odb_read_header(&size, &type, db, oid));
+            if (type == GIT_OBJ_TAG) {
+                git_object *target = 0;
+                qGitThrow(git_reference_peel(&target, r, GIT_OBJ_ANY));
+                tag.target = OId(git_object_id(target));
+                git_object_free(target);
+            } else {
+                tag.target = tag.oid;
+            }
+        }
+        tags.append(tag);
+    }
+    if (err != GIT_ITEROVER) {
+        qGitThrow(err);
+    }
+    giterr_clear();
+
+    return tags;
+}
+
 QStringList Repository::listReferences() const
 {
     git_strarray refs;
@@ -409,6 +633,64 @@ StatusList Repository::status(const StatusOptions &options) const
     return StatusList(status_list);
 }
 
+StatusList Repository::status(const StatusOptions &options, const StatCache &cache) const
+{
+    if (cache.isNull()) {
+        return status(options);
+    }
+
+    git_status_options opt = options.constData();
+    const Index index = prepareStatCache(cache, opt.flags, GIT_STATUS_OPT_UPDATE_INDEX);
+
+    // git_status_list_new() only compares with the repository's index
+    return StatusList(QSharedPointer<internal::StatusDiffs>(new internal::StatusDiffs(SAFE_DATA, index.data(), opt)));
+}
+
+StatusList Repository::status(const StatusOptions &options, const QStringList &changedPaths) const
+{
+    QList<QByteArray> paths;
+    foreach (const QString &path, changedPaths) {
+        paths.append(PathCodec::toLibGit2(path));
+    }
+    return StatusList(internal::hintedStatus(SAFE_DATA, options.constData(), paths));
+}
+
+StatusList Repository::status(const StatusOptions &options, ChangeHintProvider &hints) const
+{
+    // what differed last time may still differ, even if it didn't change since
+    QStringList &pending = d_ptr->m_pendingPaths[&hints];
+    QStringList changedPaths;
+    const StatusList list = hints.changedPaths(changedPaths)
+            ? status(options, changedPaths + pending)
+            : parallelStatus(options);
+
+    pending.clear();
+    for (const StatusEntry &entry : list) {
+        if (entry.flags() == GIT_STATUS_CURRENT) {
+            continue;
+        }
+        // an untracked directory stands for everything below it
+        QString path = entry.path();
+        if (path.endsWith(QChar('/'))) {
+            path.chop(1);
+        }
+        pending.append(path);
+        if (entry.rawOldPath() && qstrcmp(entry.rawOldPath(), entry.rawNewPath()) != 0) {
+            pending.append(PathCodec::fromLibGit2(entry.rawOldPath()));
+        }
+    }
+    return list;
+}
+
+StatusList Repository::parallelStatus(const StatusOptions &options, int threads) const
+{
+    QList<QByteArray> paths;
+    if (!internal::scanWorkdir(SAFE_DATA, threads, paths)) {
+        return status(options);
+    }
+    return StatusList(internal::hintedStatus(SAFE_DATA, options.constData(), paths, true));
+}
+
 Repository::GraphRelationship Repository::commitRelationship(const Commit &local, const Commit &upstream) const
 {
     GraphRelationship result;
@@ -423,6 +705,59 @@ Diff Repository::diffTrees(const Tree &oldTree, const Tree &newTree) const
     return Diff(diff);
 }
 
+Diff Repository::diffTreeToIndex(const Tree &oldTree, const Index &index) const
+{
+    git_diff *diff = NULL;
+    qGitThrow(git_diff_tree_to_index(&diff, SAFE_DATA, oldTree.data(), index.data(), NULL));
+    return Diff(diff);
+}
+
+Diff Repository::diffIndexToWorkdir(const Index &index, const StatCache &cache) const
+{
+    git_diff_options opts = GIT_DIFF_OPTIONS_INIT;
+    Index usedIndex(index);
+    if (!cache.isNull()) {
+        const Index cached = prepareStatCache(cache, opts.flags, GIT_DIFF_UPDATE_INDEX);
+        if (usedIndex.data() == NULL) {
+            usedIndex = cached;
+        } else if (usedIndex.data() != cached.data()) {
+            // the stat data of another index is of no use
+            opts.flags &= ~GIT_DIFF_UPDATE_INDEX;
+        }
+    }
+
+    git_diff *diff = NULL;
+    qGitThrow(git_diff_index_to_workdir(&diff, SAFE_DATA, usedIndex.data(), &opts));
+    return Diff(diff);
+}
+
+Diff Repository::diffTreeToWorkdir(const Tree &oldTree, bool withIndex, const StatCache &cache) const
+{
+    git_diff_options opts = GIT_DIFF_OPTIONS_INIT;
+    git_diff *diff = NULL;
+    if (!withIndex) {
+        // no index involved, so nothing to share through the cache
+        qGitThrow(git_diff_tree_to_workdir(&diff, SAFE_DATA, oldTree.data(), &opts));
+        return Diff(diff);
+    }
+    if (cache.isNull()) {
+        qGitThrow(git_diff_tree_to_workdir_with_index(&diff, SAFE_DATA, oldTree.data(), &opts));
+        return Diff(diff);
+    }
+
+    // what git_diff_tree_to_workdir_with_index() does, but with the cache's index
+    const Index index = prepareStatCache(cache, opts.flags, GIT_DIFF_UPDATE_INDEX);
+    qGitThrow(git_diff_tree_to_index(&diff, SAFE_DATA, oldTree.data(), index.data(), &opts));
+    Diff result(diff);
+
+    git_diff *workdir = NULL;
+    qGitThrow(git_diff_index_to_workdir(&workdir, SAFE_DATA, index.data(), &opts));
+    const int error = git_diff_merge(diff, workdir);
+    git_diff_free(workdir);
+    qGitThrow(error);
+    return result;
+}
+
 Commit Repository::mergeBase(const Commit &one, const Commit &two) const
 {
     OId out;
@@ -439,6 +774,51 @@ Index Repository::mergeTrees(const Tree &our, const Tree &their, const Tree &anc
     return Index(index);
 }
 
+Index Repository::applyToTree(const Tree &base, const Diff &diff) const
+{
+    git_index *index = NULL;
+    qGitThrow(git_index_new(&index));
+    Index result(index);
+    if (!base.isNull()) {
+        qGitThrow(git_index_read_tree(index, base.constData()));
+    }
+
+    applyToIndex(result, diff);
+    return result;
+}
+
+QList<OId> Repository::applySeriesToTree(const Tree &base, const QList<Diff> &diffs) const
+{
+    Index index = applyToTree(base, Diff());
+
+    QList<OId> trees;
+    foreach (const Diff &diff, diffs) {
+        applyToIndex(index, diff);
+        trees.append(index.createTree(*this));
+    }
+    return trees;
+}
+
+void Repository::applyToIndex(Index &index, const Diff &diff) const
+{
+    AVOID(index.data() == NULL, "can not apply to a null index.")
+
+    if (diff.d.isNull()) {
+        return;
+    }
+    internal::PatchApplier applier(SAFE_DATA, diff.d.data());
+    applier.applyToIndex(index.data());
+}
+
+void Repository::applyToWorkdir(const Diff &diff) const
+{
+    if (diff.d.isNull()) {
+        return;
+    }
+    internal::PatchApplier applier(SAFE_DATA, diff.d.data());
+    applier.applyToWorkdir();
+}
+
 git_repository* Repository::data() const
 {
     return d_ptr->d.data();
@@ -643,4 +1023,29 @@ Repository::Identity Repository::identity() const
     return Identity{ QString::fromUtf8(name), QString::fromUtf8(email) };
 }
 
+void Repository::setRefSnapshotEnabled(bool enabled)
+{
+    if (enabled) {
+        d_ptr->enableRefSnapshot();
+    } else {
+        d_ptr->m_refSnapshot.clear();
+    }
+}
+
+bool Repository::isRefSnapshotEnabled() const
+{
+    return !d_ptr->m_refSnapshot.isNull();
+}
+
+void Repository::setTreePathCacheSize(int maxEntries)
+{
+    internal::TreePathCache::setMaxEntries(SAFE_DATA, maxEntries);
+}
+
+int Repository::treePathCacheHits() const
+{
+    QSharedPointer<internal::TreePathCache> cache = internal::TreePathCache::find(SAFE_DATA);
+    return cache ? cache->hits() : 0;
+}
+
 } // namespace LibQGit2
@@ -31,6 +31,7 @@
 #include "qgitcommit.h"
 #include "qgitdatabase.h"
 #include "qgitobject.h"
+#include "qgitoid.h"
 #include "qgitref.h"
 #include "qgittree.h"
 #include "qgitindex.h"
@@ -41,6 +42,7 @@
 #include "qgitcherrypickoptions.h"
 #include "qgitrebase.h"
 #include "qgitrebaseoptions.h"
+#include "qgitstatcache.h"
 
 namespace LibQGit2
 {
@@ -54,6 +56,7 @@ namespace LibQGit2
     class Push;
     class Remote;
     class Diff;
+    class ChangeHintProvider;
 
     /**
      * @brief Wrapper class for git_repository.
@@ -167,6 +170,30 @@ namespace LibQGit2
                                  bool acrossFs = false,
                                  const QStringList &ceilingDirs = QStringList());
 
+            /**
+             * Like discoverAndOpen(), but remembers the repository found for \a startPath
+             * so that later calls with the same arguments skip the discovery and open the
+             * repository directly, without searching the parent directories. A relative
+             * \a startPath is resolved against the current directory first.
+             *
+             * The discovery cache is shared by the whole process. If the remembered
+             * repository can no longer be opened the entry is dropped and the discovery
+             * runs again. Opening doesn't load the configuration nor the index; they are
+             * only read when first needed, e.g. by configuration() or index().
+             *
+             * @throws LibQGit2::Exception
+             * @see clearDiscoveryCache()
+             */
+            void discoverAndOpenCached(const QString &startPath,
+                                       bool acrossFs = false,
+                                       const QStringList &ceilingDirs = QStringList());
+
+            /**
+             * Forgets all the repositories remembered by discoverAndOpenCached(), e.g.
+             * after repositories have been moved or created.
+             */
+            static void clearDiscoveryCache();
+
             /**
              * Retrieve and resolve the reference pointed at by HEAD.
              *
@@ -243,6 +270,10 @@ namespace LibQGit2
             /**
              * Lookup a reference by its name in a repository and returns the oid of its target.
              *
+             * Symbolic references are resolved. With the ref snapshot enabled, a name that was
+             * resolved before is answered from memory as long as the files involved are unchanged.
+             *
+             * @see setRefSnapshotEnabled()
              * @throws LibQGit2::Exception
              * @return The OId of the target
              */
@@ -350,6 +381,25 @@ namespace LibQGit2
              */
             OId createCommit(const Tree& tree, const QList<Commit>& parents, const Signature& author, const Signature& committer, const QString& message, const QString& ref = QString());
 
+            /**
+             * Writes a new tree that is \a base with the given \a changes applied, without
+             * going through an Index.
+             *
+             * Only the subtrees along the changed paths are rewritten, so the cost depends
+             * on the number of changes and the depth of their paths, not on the size of the
+             * tree. Missing intermediate directories are created, and directories left
+             * without entries are removed.
+             *
+             * @param base The tree to start from; a null Tree starts from an empty tree.
+             * @param changes Maps paths relative to \a base to the blobs that should be stored
+             *        there. An invalid OId removes the path. Existing blobs keep their mode;
+             *        new ones are added as regular files.
+             * @return The OId of the written tree.
+             * @throws LibQGit2::Exception
+             * @see TreeBuilder
+             */
+            OId updateTree(const Tree& base, const QMap<QString, OId>& changes) const;
+
             /**
              * Create a new lightweight tag pointing at a target object
              *
@@ -437,6 +487,28 @@ namespace LibQGit2
              */
             QStringList listTags(const QString& pattern = QString()) const;
 
+            /**
+             * A tag together with the object it ultimately points to.
+             */
+            struct TagInfo {
+                QString name;   ///< the name of the tag, without "refs/tags/"
+                OId oid;        ///< the id the tag reference points to: the annotated tag object, or the target of a lightweight tag
+                OId target;     ///< the id of the first non-tag object reached by peeling the tag
+            };
+
+            /**
+             * Lists the tags whose name matches \a pattern, as listTags() does, along with
+             * their peeled targets.
+             *
+             * The peeled ids recorded in packed-refs are used when available. Otherwise only
+             * the header of the object the tag points to is read to tell annotated tags from
+             * lightweight ones, and only annotated tags are loaded to peel them.
+             *
+             * @param pattern Standard fnmatch pattern
+             * @throws LibQGit2::Exception
+             */
+            QList<TagInfo> listTagsPeeled(const QString& pattern = QString()) const;
+
             /**
              * Create a list with all references in the Repository.
              *
@@ -474,6 +546,86 @@ namespace LibQGit2
              */
             StatusList status(const StatusOptions &options) const;
 
+            /**
+             * @brief Get the status information of the Git repository, sharing stat data
+             *
+             * Works like status(const StatusOptions &) but compares HEAD and the working
+             * directory with the index of the given \a cache, whose stat data was refreshed
+             * when the cache loaded it, so only the files changed since then are hashed.
+             * The index of the repository is left alone. The index file is only written if
+             * the cache was created with StatCache::WriteIndex. A null \a cache behaves just
+             * like status(const StatusOptions &).
+             *
+             * The entries point into the diffs they were computed from, so the returned
+             * list has no StatusList::data().
+             *
+             * @throws LibQGit2::Exception
+             * @return The list of status entries
+             */
+            StatusList status(const StatusOptions &options, const StatCache &cache) const;
+
+            /**
+             * @brief Get the status information of the Git repository, checking only the
+             * given paths of the working directory
+             *
+             * Works like status(const StatusOptions &) but, instead of scanning the whole
+             * working directory, only compares \a changedPaths with the index, e.g. the
+             * paths reported by a file system monitor since the previous call. A directory
+             * stands for everything below it, so a new directory only has to be reported
+             * once. The comparison of HEAD with the index is limited to the same paths,
+             * so the cost does not depend on the size of the index.
+             *
+             * Changes to paths missing from \a changedPaths are not reported, staged
+             * ones and conflicts included, and renames are only detected between
+             * reported paths. After the index or HEAD changed, e.g. by a commit, a reset
+             * or a merge, the paths they affected must be passed as well, or
+             * status(const StatusOptions &) be used. If \a options already limit the
+             * paths, \a changedPaths is not used.
+             *
+             * @param changedPaths the paths that may have changed, relative to the
+             *        working directory
+             * @throws LibQGit2::Exception
+             * @return The list of status entries
+             */
+            StatusList status(const StatusOptions &options, const QStringList &changedPaths) const;
+
+            /**
+             * @brief Get the status information of the Git repository, checking only the
+             * paths reported by \a hints
+             *
+             * Asks \a hints for the paths that changed since its previous call and works
+             * like status(const StatusOptions &, const QStringList &) with them and with
+             * the paths that were not current in the previous status this Repository
+             * computed with \a hints, untracked directories included. If it cannot tell,
+             * the working directory is scanned with parallelStatus(), which also reports
+             * everything staged and every conflict.
+             *
+             * @throws LibQGit2::Exception
+             * @return The list of status entries
+             */
+            StatusList status(const StatusOptions &options, ChangeHintProvider &hints) const;
+
+            /**
+             * @brief Get the status information of the Git repository, scanning the
+             * working directory from several threads
+             *
+             * The tracked files are lstat'ed in parallel and compared with the stat data
+             * cached in the index, while the tracked directories are listed in parallel to
+             * find new files; directories without tracked files are not walked. The status
+             * is then computed only for the files found this way, as with
+             * status(const StatusOptions &, const QStringList &), and for the paths that
+             * differ between HEAD and the index or are conflicted.
+             *
+             * On platforms without a parallel implementation this is the same as
+             * status(const StatusOptions &).
+             *
+             * @param threads the number of threads to use; QThread::idealThreadCount() if
+             *        not positive
+             * @throws LibQGit2::Exception
+             * @return The list of status entries
+             */
+            StatusList parallelStatus(const StatusOptions &options, int threads = 0) const;
+
             /**
              * How two nodes are related to each other in a graph.
              */
@@ -512,6 +664,46 @@ namespace LibQGit2
              */
             Diff diffTrees(const Tree &oldTree, const Tree &newTree) const;
 
+            /**
+             * @brief Makes a Diff between a Tree and an Index.
+             *
+             * @param oldTree the Tree on the `old' side of the diff. If this is a NULL Tree
+             * the diff is made against an empty tree.
+             * @param index the Index on the `new' side of the diff. If this is a NULL Index
+             * the repository's index is used.
+             * @throws LibQGit2::Exception
+             * @return The Diff between the provided Tree and Index.
+             */
+            Diff diffTreeToIndex(const Tree &oldTree, const Index &index = Index()) const;
+
+            /**
+             * @brief Makes a Diff between an Index and the working directory.
+             *
+             * @param index the Index on the `old' side of the diff. If this is a NULL Index
+             * the index of the \a cache is used, or the repository's index if the cache is null.
+             * @param cache the StatCache to share stat data with other operations. The index
+             * file is only written if the cache was created with StatCache::WriteIndex.
+             * @throws LibQGit2::Exception
+             * @return The Diff between the Index and the working directory.
+             */
+            Diff diffIndexToWorkdir(const Index &index = Index(), const StatCache &cache = StatCache()) const;
+
+            /**
+             * @brief Makes a Diff between a Tree and the working directory.
+             *
+             * @param oldTree the Tree on the `old' side of the diff. If this is a NULL Tree
+             * the diff is made against an empty tree.
+             * @param withIndex if true, the index is used to find staged deletions and renames,
+             * as `git diff <tree>' does: the index of the \a cache, or the repository's index if
+             * the cache is null. If false, the working directory is compared with the tree
+             * directly and the \a cache is not used.
+             * @param cache the StatCache to share stat data with other operations. The index
+             * file is only written if the cache was created with StatCache::WriteIndex.
+             * @throws LibQGit2::Exception
+             * @return The Diff between the Tree and the working directory.
+             */
+            Diff diffTreeToWorkdir(const Tree &oldTree, bool withIndex = true, const StatCache &cache = StatCache()) const;
+
             /**
              * Finds a merge base between two commits.
              * @param one The first Commit.
@@ -536,6 +728,57 @@ namespace LibQGit2
              */
             Index mergeTrees(const Tree &our, const Tree &their, const Tree &ancestor = Tree(), const MergeOptions &opts = MergeOptions());
 
+            /**
+             * Applies a \a diff to a Tree in memory, producing an Index that reflects the
+             * result. The repository's index and working directory are not touched.
+             *
+             * When the postimage of a delta is already stored in the repository, as for diffs
+             * between trees, it is used directly. Otherwise the hunks of the patch are applied
+             * to the preimage, with the same shifted context matching `git apply` does. Binary
+             * deltas can only be applied if the diff contains binary data.
+             *
+             * The resulting Index isn't backed by the repository; use Index::createTree(const Repository&)
+             * to write it as a tree.
+             *
+             * @param base The tree the diff is applied to.
+             * @param diff The diff to apply.
+             * @return The index with the applied changes.
+             * @throws LibQGit2::Exception if any of the deltas does not apply.
+             */
+            Index applyToTree(const Tree &base, const Diff &diff) const;
+
+            /**
+             * Applies a series of patches on top of a Tree, each one on top of the result of
+             * the previous one, and writes the intermediate trees to the repository.
+             *
+             * All the patches are applied to the same in-memory Index, so writing each
+             * intermediate tree only rewrites the subtrees changed since the previous one.
+             *
+             * @param base The tree the first diff is applied to.
+             * @param diffs The diffs to apply, in order.
+             * @return The OIds of the trees resulting from each of the \a diffs.
+             * @throws LibQGit2::Exception if any of the deltas does not apply.
+             */
+            QList<OId> applySeriesToTree(const Tree &base, const QList<Diff> &diffs) const;
+
+            /**
+             * Applies a \a diff to the stage 0 entries of an \a index in memory. The
+             * changes are not written to disk until Index::write() is called.
+             *
+             * @see applyToTree()
+             * @throws LibQGit2::Exception if any of the deltas does not apply.
+             */
+            void applyToIndex(Index &index, const Diff &diff) const;
+
+            /**
+             * Applies a \a diff to the files in the working directory, without touching
+             * the index, as `git apply` does.
+             *
+             * @see applyToTree()
+             * @throws LibQGit2::Exception if any of the deltas does not apply.
+             */
+            void applyToWorkdir(const Diff &diff) const;
+
             /**
              * @brief Sets a \c Credentials object to be used for a named remote.
              *
@@ -693,6 +936,48 @@ namespace LibQGit2
              */
             Identity identity() const;
 
+            /**
+             * Enables or disables the ref snapshot used by lookupRefOId().
+             *
+             * The snapshot remembers what each looked up name resolved to, together with the
+             * stat data of packed-refs and of the loose files of the references on the way.
+             * Later lookups of the same name only check that these files are unchanged, so
+             * resolving hot references like "HEAD" doesn't read and parse any file. References
+             * updated in the last couple of seconds are not remembered, since a further update
+             * could go unnoticed on file systems with coarse timestamps.
+             *
+             * The snapshot is shared by the copies of this Repository and is disabled by default.
+             *
+             * @throws LibQGit2::Exception
+             */
+            void setRefSnapshotEnabled(bool enabled);
+
+            /**
+             * Returns true if the ref snapshot is enabled.
+             */
+            bool isRefSnapshotEnabled() const;
+
+            /**
+             * Enables a cache of the entries found at given paths of given trees, used by
+             * Commit::blobAtPath().
+             *
+             * The cache is shared by all the Repository objects opened on the same repository
+             * directory, in any thread. Since trees are immutable it never has to be
+             * invalidated; the least recently used entries are evicted once \a maxEntries
+             * is reached. A \a maxEntries of 0 disables the cache again.
+             *
+             * @throws LibQGit2::Exception
+             */
+            void setTreePathCacheSize(int maxEntries);
+
+            /**
+             * Returns how many lookups of Commit::blobAtPath() were answered by the tree
+             * path cache since it was last enabled, or 0 if it is disabled.
+             *
+             * @see setTreePathCacheSize()
+             */
+            int treePathCacheHits() const;
+
             git_repository* data() const;
             const git_repository* constData() const;
 
@@ -0,0 +1,329 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "qgitrepositorypool.h"
+#include "qgitrepository.h"
+#include "qgitconfig.h"
+#include "qgitexception.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QWaitCondition>
+
+namespace LibQGit2
+{
+
+namespace {
+
+Repository *openRepository(const QString &path)
+{
+    QScopedPointer<Repository> repo(new Repository);
+    repo->open(path);
+
+    // load the object database, including the list of packs, and the configuration
+    // now rather than while serving the first request
+    git_odb *odb = 0;
+    qGitThrow(git_repository_odb(&odb, repo->data()));
+    int err = git_odb_refresh(odb);
+    git_odb_free(odb);
+    qGitThrow(err);
+    repo->configuration();
+
+    return repo.take();
+}
+
+}
+
+struct RepositoryPool::Private {
+    struct IdleHandle {
+        Repository *repo;
+        QElapsedTimer since;
+    };
+
+    struct Handles {
+        Handles() : open(0) {}
+
+        // ordered by release time, the most recently used last
+        QList<IdleHandle> idle;
+        int open;
+    };
+
+    Private(int maxHandlesPerPath, int idleTimeoutMsecs)
+        : m_maxHandles(qMax(1, maxHandlesPerPath)),
+          m_idleTimeout(idleTimeoutMsecs),
+          m_closed(false),
+          m_stats()
+    {
+    }
+
+    ~Private()
+    {
+        qDeleteAll(takeIdle(-1));
+    }
+
+    Repository *acquire(const QString &path, int timeoutMsecs)
+    {
+        QElapsedTimer waiting;
+        waiting.start();
+        bool waited = false;
+
+        QMutexLocker lock(&m_mutex);
+        QList<Repository*> expired = takeIdle(m_idleTimeout);
+
+        forever {
+            Handles &handles = m_handles[path];
+            if (!handles.idle.isEmpty()) {
+                Repository *repo = handles.idle.takeLast().repo;
+                lend();
+                lock.unlock();
+                qDeleteAll(expired);
+                return repo;
+            }
+
+            if (handles.open < m_maxHandles) {
+                ++handles.open;
+                ++m_stats.open;
+                ++m_stats.opened;
+                lend();
+                break;
+            }
+
+            if (!waited) {
+                ++m_stats.waited;
+                waited = true;
+            }
+
+            if (timeoutMsecs < 0) {
+                m_released.wait(&m_mutex);
+                continue;
+            }
+
+            const qint64 remaining = timeoutMsecs - waiting.elapsed();
+            if (remaining <= 0 || !m_released.wait(&m_mutex, (unsigned long)remaining)) {
+                ++m_stats.timedOut;
+                lock.unlock();
+                qDeleteAll(expired);
+                throw Exception("RepositoryPool::acquire(): timed out waiting for a handle on " + path);
+            }
+        }
+
+        lock.unlock();
+        qDeleteAll(expired);
+
+        try {
+            return openRepository(path);
+        } catch (...) {
+            lock.relock();
+            --m_handles[path].open;
+            --m_stats.open;
+            --m_stats.opened;
+            --m_stats.inUse;
+            --m_stats.acquired;
+            m_released.wakeAll();
+            throw;
+        }
+    }
+
+    void release(const QString &path, Repository *repo)
+    {
+        QMutexLocker lock(&m_mutex);
+        --m_stats.inUse;
+        m_released.wakeAll();
+
+        if (m_closed) {
+            --m_handles[path].open;
+            --m_stats.open;
+            lock.unlock();
+            delete repo;
+            return;
+        }
+
+        IdleHandle handle;
+        handle.repo = repo;
+        handle.since.start();
+        m_handles[path].idle.append(handle);
+    }
+
+    void evict(qint64 olderThan)
+    {
+        QMutexLocker lock(&m_mutex);
+        QList<Repository*> expired = takeIdle(olderThan);
+        lock.unlock();
+        qDeleteAll(expired);
+    }
+
+    void close()
+    {
+        QMutexLocker lock(&m_mutex);
+        m_closed = true;
+        QList<Repository*> idle = takeIdle(-1);
+        lock.unlock();
+        qDeleteAll(idle);
+    }
+
+    Statistics statistics() const
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_stats;
+    }
+
+    qint64 idleTimeout() const
+    {
+        return m_idleTimeout;
+    }
+
+private:
+    void lend()
+    {
+        ++m_stats.acquired;
+        m_stats.peakInUse = qMax(m_stats.peakInUse, ++m_stats.inUse);
+    }
+
+    // Removes the handles idle for more than olderThan msecs, or all of them if it is
+    // negative; they are deleted by the caller once the mutex is released.
+    QList<Repository*> takeIdle(qint64 olderThan)
+    {
+        QList<Repository*> taken;
+        for (QHash<QString, Handles>::iterator it = m_handles.begin(); it != m_handles.end(); ++it) {
+            QList<IdleHandle> &idle = it->idle;
+            while (!idle.isEmpty() && (olderThan < 0 || idle.first().since.hasExpired(olderThan))) {
+                taken.append(idle.takeFirst().repo);
+                --it->open;
+            }
+        }
+
+        if (!taken.isEmpty()) {
+            m_stats.open -= taken.size();
+            m_stats.evicted += taken.size();
+            m_released.wakeAll();
+        }
+        return taken;
+    }
+
+    const int m_maxHandles;
+    const qint64 m_idleTimeout;
+    bool m_closed;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_released;
+    QHash<QString, Handles> m_handles;
+    Statistics m_stats;
+};
+
+RepositoryPool::Handle::Handle()
+    : m_repo(0)
+{
+}
+
+RepositoryPool::Handle::Handle(const QSharedPointer<Private> &pool, const QString &path, Repository *repo)
+    : m_pool(pool),
+      m_path(path),
+      m_repo(repo)
+{
+}
+
+RepositoryPool::Handle::Handle(Handle &&other)
+    : m_pool(other.m_pool),
+      m_path(other.m_path),
+      m_repo(other.m_repo)
+{
+    other.m_pool.clear();
+    other.m_repo = 0;
+}
+
+RepositoryPool::Handle &RepositoryPool::Handle::operator=(Handle &&other)
+{
+    if (this != &other) {
+        release();
+        m_pool = other.m_pool;
+        m_path = other.m_path;
+        m_repo = other.m_repo;
+        other.m_pool.clear();
+        other.m_repo = 0;
+    }
+    return *this;
+}
+
+RepositoryPool::Handle::~Handle()
+{
+    release();
+}
+
+bool RepositoryPool::Handle::isNull() const
+{
+    return m_repo == 0;
+}
+
+void RepositoryPool::Handle::release()
+{
+    if (m_repo) {
+        m_pool->release(m_path, m_repo);
+        m_pool.clear();
+        m_repo = 0;
+    }
+}
+
+Repository &RepositoryPool::Handle::repository() const
+{
+    if (!m_repo) {
+        throw Exception("RepositoryPool::Handle::repository(): the handle is null");
+    }
+    return *m_repo;
+}
+
+Repository *RepositoryPool::Handle::operator->() const
+{
+    return &repository();
+}
+
+RepositoryPool::RepositoryPool(int maxHandlesPerPath, int idleTimeoutMsecs)
+    : d_ptr(new Private(maxHandlesPerPath, idleTimeoutMsecs))
+{
+}
+
+RepositoryPool::~RepositoryPool()
+{
+    d_ptr->close();
+}
+
+RepositoryPool::Handle RepositoryPool::acquire(const QString &path, int timeoutMsecs)
+{
+    Repository *repo = d_ptr->acquire(path, timeoutMsecs);
+    return Handle(d_ptr, path, repo);
+}
+
+void RepositoryPool::evictIdle()
+{
+    d_ptr->evict(d_ptr->idleTimeout());
+}
+
+void RepositoryPool::clear()
+{
+    d_ptr->evict(-1);
+}
+
+RepositoryPool::Statistics RepositoryPool::statistics() const
+{
+    return d_ptr->statistics();
+}
+
+}
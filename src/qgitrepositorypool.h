@@ -0,0 +1,150 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_REPOSITORYPOOL_H
+#define LIBQGIT2_REPOSITORYPOOL_H
+
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+
+#include "libqgit2_config.h"
+
+namespace LibQGit2
+{
+
+class Repository;
+
+/**
+ * @brief Thread-safe pool of opened repositories.
+ *
+ * libgit2 repository handles, and the objects obtained from them, must not be used
+ * by several threads at the same time. A RepositoryPool keeps up to a fixed number of
+ * handles opened per repository path and lends each of them to one thread at a time,
+ * so that a server doesn't have to pay the cost of opening a repository per request.
+ *
+ * Handles are opened on demand, with their object database and configuration loaded
+ * right away. Handles that stay idle longer than the idle timeout are closed the next
+ * time the pool is used, or when evictIdle() is called.
+ *
+ * @ingroup LibQGit2
+ * @{
+ */
+class LIBQGIT2_EXPORT RepositoryPool
+{
+    struct Private;
+
+public:
+    /**
+     * Usage counters of a pool.
+     */
+    struct Statistics {
+        int open;               ///< handles currently open, idle or in use
+        int inUse;              ///< handles currently lent
+        int peakInUse;          ///< the highest value inUse has reached
+        quint64 acquired;       ///< successful acquire() calls
+        quint64 waited;         ///< acquire() calls that had to wait for a handle to be released
+        quint64 timedOut;       ///< acquire() calls that gave up waiting
+        quint64 opened;         ///< handles opened since the pool was created
+        quint64 evicted;        ///< idle handles closed by the pool
+    };
+
+    /**
+     * @brief A repository lent by a RepositoryPool.
+     *
+     * The repository goes back to the pool when the Handle is destroyed or release()
+     * is called. A Handle can be moved but not copied; neither the Repository nor
+     * anything obtained from it may be used after the Handle has been released.
+     */
+    class LIBQGIT2_EXPORT Handle
+    {
+    public:
+        /**
+         * Constructs a null Handle.
+         */
+        Handle();
+        Handle(Handle &&other);
+        Handle &operator=(Handle &&other);
+        ~Handle();
+
+        Handle(const Handle &other) = delete;
+        Handle &operator=(const Handle &other) = delete;
+
+        bool isNull() const;
+
+        /**
+         * Gives the repository back to the pool. The Handle becomes null.
+         */
+        void release();
+
+        Repository &repository() const;
+        Repository *operator->() const;
+
+    private:
+        Handle(const QSharedPointer<Private> &pool, const QString &path, Repository *repo);
+
+        QSharedPointer<Private> m_pool;
+        QString m_path;
+        Repository *m_repo;
+
+        friend class RepositoryPool;
+    };
+
+    /**
+     * Creates a pool keeping at most \a maxHandlesPerPath opened handles per repository,
+     * and closing the handles that stay idle for more than \a idleTimeoutMsecs.
+     */
+    explicit RepositoryPool(int maxHandlesPerPath = 4, int idleTimeoutMsecs = 60000);
+
+    /**
+     * Closes the idle handles. Handles still lent are closed once they are released.
+     */
+    ~RepositoryPool();
+
+    RepositoryPool(const RepositoryPool &other) = delete;
+    RepositoryPool &operator=(const RepositoryPool &other) = delete;
+
+    /**
+     * Lends a handle on the repository at \a path, opening a new one if all the opened
+     * handles are in use and the limit hasn't been reached yet. Otherwise waits for a
+     * handle to be released, for at most \a timeoutMsecs if it isn't negative.
+     *
+     * @throws LibQGit2::Exception if the repository can't be opened or the timeout expires
+     */
+    Handle acquire(const QString &path, int timeoutMsecs = -1);
+
+    /**
+     * Closes the handles that have been idle for longer than the idle timeout.
+     */
+    void evictIdle();
+
+    /**
+     * Closes all the idle handles.
+     */
+    void clear();
+
+    Statistics statistics() const;
+
+private:
+    QSharedPointer<Private> d_ptr;
+};
+
+/** @} */
+
+}
+
+#endif // LIBQGIT2_REPOSITORYPOOL_H
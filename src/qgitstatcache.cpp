@@ -0,0 +1,105 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "qgitstatcache.h"
+#include "qgitrepository.h"
+
+#include "private/indexrefresher.h"
+
+namespace LibQGit2
+{
+
+struct StatCache::Private {
+    Private(const Index &index, UpdateMode mode)
+        : m_index(index),
+          m_mode(mode),
+          m_loaded(false)
+    {
+    }
+
+    Index index()
+    {
+        if (!m_loaded) {
+            refresh();
+        }
+        return m_index;
+    }
+
+    void refresh()
+    {
+        // in-memory indexes have nothing to be read
+        if (git_index_path(m_index.data()) != NULL) {
+            m_index.read(false);
+        }
+        m_loaded = true;
+
+        // with WriteIndex, libgit2 refreshes the stat data as part of each operation
+        git_repository *repo = git_index_owner(m_index.data());
+        if (m_mode == KeepInMemory && repo && !git_repository_is_bare(repo)) {
+            internal::IndexRefresher(m_index.data(), 0).refreshStatData(QStringList());
+        }
+    }
+
+    UpdateMode mode() const
+    {
+        return m_mode;
+    }
+
+private:
+    Index m_index;
+    UpdateMode m_mode;
+    bool m_loaded;
+};
+
+StatCache::StatCache()
+{
+}
+
+StatCache::StatCache(const Repository &repository, UpdateMode mode)
+    : d_ptr(new Private(repository.index(), mode))
+{
+}
+
+StatCache::StatCache(const Index &index, UpdateMode mode)
+    : d_ptr(index.data() ? new Private(index, mode) : 0)
+{
+}
+
+bool StatCache::isNull() const
+{
+    return d_ptr.isNull();
+}
+
+StatCache::UpdateMode StatCache::updateMode() const
+{
+    return d_ptr.isNull() ? KeepInMemory : d_ptr->mode();
+}
+
+Index StatCache::index() const
+{
+    return d_ptr.isNull() ? Index() : d_ptr->index();
+}
+
+void StatCache::refresh()
+{
+    if (!d_ptr.isNull()) {
+        d_ptr->refresh();
+    }
+}
+
+}
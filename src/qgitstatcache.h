@@ -0,0 +1,122 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_STATCACHE_H
+#define LIBQGIT2_STATCACHE_H
+
+#include <QtCore/QSharedPointer>
+
+#include "libqgit2_config.h"
+#include "qgitindex.h"
+
+namespace LibQGit2
+{
+
+class Repository;
+
+/**
+ * @brief Stat data shared between consecutive working directory comparisons.
+ *
+ * Comparing the working directory with the index stats every file and rehashes the
+ * contents of the files whose stat data doesn't match the one recorded in the index.
+ * A StatCache keeps one \c Index loaded for a series of diffs and status queries and
+ * lets each of them record the stat data it had to verify, so the next operation
+ * sharing the same StatCache doesn't have to hash those files again.
+ *
+ * Only the stat data of the entries whose content still matches is refreshed, so
+ * nothing is staged. By default it is refreshed in memory, once, when the Index is
+ * loaded, and again on refresh(); the operations sharing the cache then only hash
+ * the files that changed since. The index file is left alone; writing it is up to
+ * the caller, e.g. through Index::write(). With \c WriteIndex each operation lets
+ * libgit2 refresh the stat data it verified and write the index, along with any
+ * other unwritten change made to it.
+ *
+ * A default constructed StatCache is null, and passing it to an operation means no
+ * sharing takes place.
+ *
+ * @ingroup LibQGit2
+ * @{
+ */
+class LIBQGIT2_EXPORT StatCache
+{
+public:
+    /**
+     * Where the refreshed stat data goes.
+     */
+    enum UpdateMode {
+        KeepInMemory,   ///< only the in-memory Index is updated
+        WriteIndex      ///< the Index is also written to disk
+    };
+
+    /**
+     * Constructs a null StatCache.
+     */
+    StatCache();
+
+    /**
+     * Constructs a StatCache sharing the Index of the given \a repository.
+     *
+     * @throws LibQGit2::Exception
+     */
+    explicit StatCache(const Repository &repository, UpdateMode mode = KeepInMemory);
+
+    /**
+     * Constructs a StatCache sharing the given \a index.
+     */
+    explicit StatCache(const Index &index, UpdateMode mode = KeepInMemory);
+
+    /**
+     * Returns true if this is a null StatCache.
+     */
+    bool isNull() const;
+
+    /**
+     * Returns where the stat data refreshed through this cache goes.
+     */
+    UpdateMode updateMode() const;
+
+    /**
+     * Returns the Index shared through this cache.
+     *
+     * The on-disk index is read, and its stat data refreshed, only the first time this
+     * is called and on refresh(), so subsequent operations keep working on the stat
+     * data gathered before.
+     *
+     * @throws LibQGit2::Exception
+     */
+    Index index() const;
+
+    /**
+     * Reads the index again if its file changed since it was read and, with
+     * \c KeepInMemory, refreshes its stat data again. Call it once the working
+     * directory changed, to spare the following operations hashing the same files.
+     *
+     * @throws LibQGit2::Exception
+     */
+    void refresh();
+
+private:
+    struct Private;
+    QSharedPointer<Private> d_ptr;
+};
+
+/** @} */
+
+}
+
+#endif // LIBQGIT2_STATCACHE_H
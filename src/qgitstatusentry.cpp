@@ -25,6 +25,8 @@
 #include "qgitstatus.h"
 #include "qgitdiffdelta.h"
 
+#include "private/pathcodec.h"
+
 using namespace LibQGit2;
 
 StatusEntry::StatusEntry(const git_status_entry *entry)
@@ -41,11 +43,38 @@ StatusEntry::~StatusEntry()
 {
 }
 
+bool StatusEntry::isNull() const
+{
+    return d == 0;
+}
+
 Status StatusEntry::status() const
 {
     return Status(d->status);
 }
 
+unsigned int StatusEntry::flags() const
+{
+    return d->status;
+}
+
+const char *StatusEntry::rawOldPath() const
+{
+    const git_diff_delta *delta = d->head_to_index ? d->head_to_index : d->index_to_workdir;
+    return delta ? delta->old_file.path : 0;
+}
+
+const char *StatusEntry::rawNewPath() const
+{
+    const git_diff_delta *delta = d->index_to_workdir ? d->index_to_workdir : d->head_to_index;
+    return delta ? delta->new_file.path : 0;
+}
+
+QString StatusEntry::path() const
+{
+    return PathCodec::fromLibGit2(rawNewPath());
+}
+
 DiffDelta StatusEntry::headToIndex() const
 {
     return DiffDelta(d->head_to_index);
@@ -55,3 +84,8 @@ DiffDelta StatusEntry::indexToWorkdir() const
 {
     return DiffDelta(d->index_to_workdir);
 }
+
+const git_status_entry *StatusEntry::data() const
+{
+    return d;
+}
@@ -24,6 +24,8 @@
 
 #include "git2.h"
 
+#include <QtCore/QString>
+
 namespace LibQGit2
 {
 
@@ -49,11 +51,38 @@ public:
 
     ~StatusEntry();
 
+    /**
+     * Returns true if this entry doesn't point to any data.
+     */
+    bool isNull() const;
+
     /**
      * Return the status of the entry
      */
     Status status() const;
 
+    /**
+     * Returns the status flags of the entry, a combination of \c git_status_t values.
+     */
+    unsigned int flags() const;
+
+    /**
+     * Returns the path of the entry before any rename, as stored by libgit2, without
+     * any conversion. The string is valid as long as the StatusList it comes from.
+     */
+    const char *rawOldPath() const;
+
+    /**
+     * Returns the path of the entry after any rename, as stored by libgit2, without
+     * any conversion. The string is valid as long as the StatusList it comes from.
+     */
+    const char *rawNewPath() const;
+
+    /**
+     * Returns the path of the entry after any rename.
+     */
+    QString path() const;
+
     /**
      * Returns the diff between HEAD and index.
      */
@@ -64,6 +93,8 @@ public:
      */
     DiffDelta indexToWorkdir() const;
 
+    const git_status_entry *data() const;
+
 private:
     const git_status_entry* d;
 };
@@ -19,14 +19,59 @@
 
 
 #include <QtCore/QFile>
+#include <QtCore/QVector>
 
 #include "qgitstatuslist.h"
+#include "qgitexception.h"
+
+#include "private/pathcodec.h"
+#include "private/statusdiffs.h"
+#include "private/strarray.h"
 
 namespace LibQGit2
 {
 
+struct StatusList::Private {
+    explicit Private(git_status_list *list)
+        : list(list, git_status_list_free),
+          selected(false)
+    {
+    }
+
+    explicit Private(const QSharedPointer<internal::StatusDiffs> &diffs)
+        : diffs(diffs),
+          selected(true)
+    {
+        const QVector<git_status_entry> &all = diffs->entries();
+        entries.reserve(all.size());
+        for (const git_status_entry &entry : all) {
+            entries.append(&entry);
+        }
+    }
+
+    size_t count() const
+    {
+        return selected ? size_t(entries.size()) : git_status_list_entrycount(list.data());
+    }
+
+    const git_status_entry *at(size_t position) const
+    {
+        return selected ? entries.at(int(position)) : git_status_byindex(list.data(), position);
+    }
+
+    QSharedPointer<git_status_list> list;
+    QSharedPointer<internal::StatusDiffs> diffs;    // or the diffs the entries point into
+    QVector<const git_status_entry *> entries;      // the entries of a filtered or diff-based list
+    bool selected;                                  // true if entries is used
+};
+
 StatusList::StatusList(git_status_list *status_list)
-    : d(status_list, git_status_list_free)
+    : d(status_list ? new Private(status_list) : 0)
+{
+}
+
+StatusList::StatusList(const QSharedPointer<internal::StatusDiffs> &diffs)
+    : d(new Private(diffs))
 {
 }
 
@@ -39,24 +84,101 @@ StatusList::~StatusList()
 {
 }
 
-size_t StatusList::entryCount()
+StatusEntry StatusList::entryAt(const Private *list, size_t position)
+{
+    return StatusEntry(list->at(position));
+}
+
+StatusList::Summary::Summary()
+    : indexNew(0), indexModified(0), indexDeleted(0), indexRenamed(0), indexTypeChanged(0),
+      workdirNew(0), workdirModified(0), workdirDeleted(0), workdirRenamed(0), workdirTypeChanged(0),
+      ignored(0), conflicted(0)
+{
+}
+
+size_t StatusList::entryCount() const
 {
-    return git_status_list_entrycount(data());
+    return d.isNull() ? 0 : d->count();
 }
 
-const StatusEntry StatusList::entryByIndex(size_t idx)
+const StatusEntry StatusList::entryByIndex(size_t idx) const
 {
-    return StatusEntry(git_status_byindex(data(), idx));
+    return StatusEntry(d.isNull() ? 0 : d->at(idx));
+}
+
+StatusList::const_iterator StatusList::begin() const
+{
+    return const_iterator(d.data(), 0);
+}
+
+StatusList::const_iterator StatusList::end() const
+{
+    return const_iterator(d.data(), entryCount());
+}
+
+StatusList::Summary StatusList::summary() const
+{
+    Summary summary;
+    const size_t count = entryCount();
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned int flags = d->at(i)->status;
+        summary.indexNew += (flags & GIT_STATUS_INDEX_NEW) ? 1 : 0;
+        summary.indexModified += (flags & GIT_STATUS_INDEX_MODIFIED) ? 1 : 0;
+        summary.indexDeleted += (flags & GIT_STATUS_INDEX_DELETED) ? 1 : 0;
+        summary.indexRenamed += (flags & GIT_STATUS_INDEX_RENAMED) ? 1 : 0;
+        summary.indexTypeChanged += (flags & GIT_STATUS_INDEX_TYPECHANGE) ? 1 : 0;
+        summary.workdirNew += (flags & GIT_STATUS_WT_NEW) ? 1 : 0;
+        summary.workdirModified += (flags & GIT_STATUS_WT_MODIFIED) ? 1 : 0;
+        summary.workdirDeleted += (flags & GIT_STATUS_WT_DELETED) ? 1 : 0;
+        summary.workdirRenamed += (flags & GIT_STATUS_WT_RENAMED) ? 1 : 0;
+        summary.workdirTypeChanged += (flags & GIT_STATUS_WT_TYPECHANGE) ? 1 : 0;
+        summary.ignored += (flags & GIT_STATUS_IGNORED) ? 1 : 0;
+        summary.conflicted += (flags & GIT_STATUS_CONFLICTED) ? 1 : 0;
+    }
+    return summary;
+}
+
+StatusList StatusList::filtered(const QStringList &pathspec) const
+{
+    if (d.isNull() || pathspec.isEmpty()) {
+        return *this;
+    }
+
+    QList<QByteArray> patterns;
+    foreach (const QString &pattern, pathspec) {
+        patterns.append(PathCodec::toLibGit2(pattern));
+    }
+    internal::StrArray patternArray(patterns);
+    git_pathspec *ps = 0;
+    qGitThrow(git_pathspec_new(&ps, &patternArray.data()));
+
+    StatusList result(*this);
+    result.d = QSharedPointer<Private>(new Private(*d));
+    result.d->entries.clear();
+    result.d->selected = true;
+    const size_t count = d->count();
+    for (size_t i = 0; i < count; ++i) {
+        const git_status_entry *entry = d->at(i);
+        const StatusEntry view(entry);
+        const char *oldPath = view.rawOldPath();
+        const char *newPath = view.rawNewPath();
+        if ((newPath && git_pathspec_matches_path(ps, GIT_PATHSPEC_DEFAULT, newPath))
+                || (oldPath && git_pathspec_matches_path(ps, GIT_PATHSPEC_DEFAULT, oldPath))) {
+            result.d->entries.append(entry);
+        }
+    }
+    git_pathspec_free(ps);
+    return result;
 }
 
 git_status_list* StatusList::data() const
 {
-    return d.data();
+    return d.isNull() ? 0 : d->list.data();
 }
 
 const git_status_list* StatusList::constData() const
 {
-    return d.data();
+    return data();
 }
 
 }
@@ -21,14 +21,21 @@
 #define LIBQGIT2_STATUS_LIST_H
 
 #include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
 
 #include "git2.h"
 
 #include "libqgit2_config.h"
+#include "qgitlistiterator.h"
 #include "qgitstatusentry.h"
 
 namespace LibQGit2
 {
+
+namespace internal {
+class StatusDiffs;
+}
+
 /**
  * @brief Wrapper class for git_status_list.
  *
@@ -40,7 +47,43 @@ namespace LibQGit2
  */
 class LIBQGIT2_EXPORT StatusList
 {
+private:
+    struct Private;
+    static StatusEntry entryAt(const Private *list, size_t position);
+
 public:
+    /**
+     * @brief Iterates over the entries of a StatusList.
+     *
+     * Dereferencing it returns a StatusEntry pointing into the list, so iterating
+     * allocates nothing.
+     */
+    typedef ListIterator<const Private *, StatusEntry, &StatusList::entryAt> const_iterator;
+
+    /**
+     * @brief The number of entries of a StatusList in each category.
+     *
+     * An entry is counted in every category it belongs to, e.g. a file modified in
+     * the index and then in the working directory counts in indexModified and in
+     * workdirModified.
+     */
+    struct Summary {
+        Summary();
+
+        int indexNew;
+        int indexModified;
+        int indexDeleted;
+        int indexRenamed;
+        int indexTypeChanged;
+        int workdirNew;         ///< untracked files
+        int workdirModified;
+        int workdirDeleted;
+        int workdirRenamed;
+        int workdirTypeChanged;
+        int ignored;
+        int conflicted;
+    };
+
     explicit StatusList(git_status_list *status_list = 0);
 
     StatusList(const StatusList& other);
@@ -50,23 +93,55 @@ public:
     /**
      * Returns the number of entries in the status list.
      */
-    size_t entryCount();
+    size_t entryCount() const;
 
     /**
      * Returns the entry with the given index.
      */
-    const StatusEntry entryByIndex(size_t idx);
+    const StatusEntry entryByIndex(size_t idx) const;
 
+    /**
+     * Returns an iterator pointing to the first entry of the list.
+     */
+    const_iterator begin() const;
+
+    /**
+     * Returns an iterator pointing past the last entry of the list.
+     */
+    const_iterator end() const;
+
+    /**
+     * Counts the entries in each category, in a single pass over the list.
+     */
+    Summary summary() const;
+
+    /**
+     * Returns the entries whose path, before or after a rename, matches \a pathspec,
+     * in the same order. The patterns follow the pathspec rules of git, e.g. "src/" or
+     * "*.cpp"; an empty \a pathspec matches every entry.
+     *
+     * The returned list shares the entries of this one, so filtering copies no entry
+     * and its summary() counts the matching entries only.
+     *
+     * @throws LibQGit2::Exception
+     */
+    StatusList filtered(const QStringList &pathspec) const;
+
+    /**
+     * Returns the libgit2 list the entries come from. For a filtered() list, it also
+     * contains the entries that didn't match. The status computed with a StatCache
+     * comes from diffs instead, and has no such list.
+     */
     git_status_list* data() const;
     const git_status_list* constData() const;
 
 private:
-    typedef QSharedPointer<git_status_list> ptr_type;
-    ptr_type d;
+    friend class Repository;
+    explicit StatusList(const QSharedPointer<internal::StatusDiffs> &diffs);
 
+    QSharedPointer<Private> d;
 };
 
-
 /**@}*/
 }
 
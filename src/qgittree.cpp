@@ -23,12 +23,94 @@
 #include "qgittreeentry.h"
 #include "qgitrepository.h"
 #include "qgitoid.h"
+#include "qgitexception.h"
 
+#include "private/namepool.h"
 #include "private/pathcodec.h"
 
+#include <QHash>
+
+#include <exception>
+
 namespace LibQGit2
 {
 
+namespace {
+
+struct WalkPayload {
+    explicit WalkPayload(const Tree::WalkCallback &callback)
+        : callback(callback),
+          stopped(false)
+    {
+        // with reserved capacity, truncating the path keeps its storage
+        path.reserve(256);
+    }
+
+    const Tree::WalkCallback &callback;
+    QByteArray path;
+    bool stopped;
+    std::exception_ptr exception;
+};
+
+int walkCallback(const char *root, const git_tree_entry *entry, void *payload)
+{
+    WalkPayload *p = static_cast<WalkPayload*>(payload);
+
+    p->path.resize(0);
+    p->path.append(root).append(git_tree_entry_name(entry));
+
+    Tree::WalkResult result;
+    try {
+        result = p->callback(p->path, TreeEntry(entry));
+    } catch (...) {
+        // do not unwind through libgit2
+        p->exception = std::current_exception();
+        result = Tree::WalkStop;
+    }
+
+    switch (result) {
+    case Tree::WalkSkipSubtree:
+        return 1;
+    case Tree::WalkStop:
+        p->stopped = true;
+        return -1;
+    default:
+        return 0;
+    }
+}
+
+typedef QHash<QByteArray, QSharedPointer<git_tree> > SubtreeCache;
+
+// Resolves the subtree at \a dir below \a root, remembering every intermediate tree
+// (missing ones as null) so that paths sharing a prefix look it up only once.
+const git_tree *subtree(SubtreeCache &cache, const git_tree *root, const QByteArray &dir)
+{
+    if (dir.isEmpty()) {
+        return root;
+    }
+
+    SubtreeCache::const_iterator it = cache.constFind(dir);
+    if (it != cache.constEnd()) {
+        return it->data();
+    }
+
+    const int slash = dir.lastIndexOf('/');
+    const git_tree *parent = subtree(cache, root, slash < 0 ? QByteArray() : dir.left(slash));
+
+    git_tree *tree = 0;
+    if (parent) {
+        const git_tree_entry *entry = git_tree_entry_byname(parent, dir.constData() + slash + 1);
+        if (entry && git_tree_entry_type(entry) == GIT_OBJ_TREE) {
+            qGitThrow(git_tree_lookup(&tree, git_tree_owner(root), git_tree_entry_id(entry)));
+        }
+    }
+
+    cache.insert(dir, QSharedPointer<git_tree>(tree, git_tree_free));
+    return tree;
+}
+
+}
+
 Tree::Tree(git_tree *tree)
     : Object(reinterpret_cast<git_object*>(tree))
 {
@@ -48,19 +130,86 @@ OId Tree::oid()
     return OId(git_tree_id(data()));
 }
 
-size_t Tree::entryCount()
+size_t Tree::entryCount() const
 {
     return git_tree_entrycount(data());
 }
 
 TreeEntry Tree::entryByName(const QString& fileName) const
 {
-    return TreeEntry(git_tree_entry_byname(constData(), PathCodec::toLibGit2(fileName)));
+    return TreeEntry(git_tree_entry_byname(constData(), PathCodec::toLibGit2(fileName)), *this);
 }
 
 TreeEntry Tree::entryByIndex(int idx) const
 {
-    return TreeEntry(git_tree_entry_byindex(data(), idx));
+    return TreeEntry(git_tree_entry_byindex(data(), idx), *this);
+}
+
+QVector<TreeEntryInfo> Tree::entryInfos() const
+{
+    const size_t count = entryCount();
+    QVector<TreeEntryInfo> infos;
+    infos.reserve(int(count));
+
+    // one lock of the name pool for the whole tree
+    internal::NameInterner interner;
+    for (size_t i = 0; i < count; ++i) {
+        const git_tree_entry *entry = git_tree_entry_byindex(constData(), i);
+        infos.append(TreeEntryInfo(entry, interner.intern(git_tree_entry_name(entry))));
+    }
+    return infos;
+}
+
+TreeEntry Tree::entryByPath(const QString& path) const
+{
+    git_tree_entry *entry = 0;
+    int err = git_tree_entry_bypath(&entry, constData(), PathCodec::toLibGit2(path));
+    if (err == GIT_ENOTFOUND) {
+        giterr_clear();
+        return TreeEntry(0);
+    }
+    qGitThrow(err);
+    return TreeEntry(entry, true);
+}
+
+QList<TreeEntry> Tree::entriesByPaths(const QStringList& paths) const
+{
+    SubtreeCache subtrees;
+    QList<TreeEntry> entries;
+    entries.reserve(paths.size());
+
+    foreach (const QString &path, paths) {
+        const QByteArray encoded = PathCodec::toLibGit2(path);
+        const int slash = encoded.lastIndexOf('/');
+        const git_tree *tree = subtree(subtrees, constData(), slash < 0 ? QByteArray() : encoded.left(slash));
+
+        git_tree_entry *entry = 0;
+        const git_tree_entry *found = tree ? git_tree_entry_byname(tree, encoded.constData() + slash + 1) : 0;
+        if (found) {
+            // the subtree holding it is freed on return
+            qGitThrow(git_tree_entry_dup(&entry, found));
+        }
+        entries.append(TreeEntry(entry, true));
+    }
+
+    return entries;
+}
+
+void Tree::walk(WalkMode mode, const WalkCallback &callback) const
+{
+    WalkPayload payload(callback);
+    int err = git_tree_walk(constData(), git_treewalk_mode(mode), &walkCallback, &payload);
+
+    if (payload.exception) {
+        giterr_clear();
+        std::rethrow_exception(payload.exception);
+    }
+    if (payload.stopped) {
+        // stopping on request is not an error
+        giterr_clear();
+        return;
+    }
+    qGitThrow(err);
 }
 
 git_tree* Tree::data() const
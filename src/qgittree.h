@@ -23,13 +23,20 @@
 
 #include "qgitobject.h"
 
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include <functional>
 
 namespace LibQGit2
 {
     class Repository;
     class OId;
     class TreeEntry;
+    class TreeEntryInfo;
 
     /**
      * @brief Wrapper class for git_tree.
@@ -49,6 +56,33 @@ namespace LibQGit2
              */
             explicit Tree(git_tree *tree = 0);
 
+            /**
+             * The order in which walk() visits the entries of the tree.
+             */
+            enum WalkMode {
+                PreOrder = GIT_TREEWALK_PRE,    ///< a subtree entry is visited before its children
+                PostOrder = GIT_TREEWALK_POST   ///< a subtree entry is visited after its children
+            };
+
+            /**
+             * Tells walk() how to proceed after an entry has been visited.
+             */
+            enum WalkResult {
+                WalkContinue,       ///< continue with the next entry
+                WalkSkipSubtree,    ///< do not descend into this entry; only meaningful with PreOrder
+                WalkStop            ///< stop the walk
+            };
+
+            /**
+             * Callback invoked by walk() for each entry.
+             *
+             * \a path is the full path of the entry relative to this tree, encoded as
+             * stored by libgit2. The same buffer is reused for every entry, so it must be
+             * copied if it has to outlive the call. \a entry is only valid during the call;
+             * construct a TreeEntryInfo from it to keep its data.
+             */
+            typedef std::function<WalkResult (const QByteArray &path, const TreeEntry &entry)> WalkCallback;
+
             /**
              * Copy constructor; creates a copy of the object, sharing the same underlaying data
              * structure.
@@ -70,10 +104,13 @@ namespace LibQGit2
              * Get the number of entries listed in a tree
              * @return the number of entries in the tree
              */
-            size_t entryCount();
+            size_t entryCount() const;
 
             /**
              * Lookup a tree entry by its filename
+             *
+             * The returned entry keeps this tree alive.
+             *
              * @param filename the filename of the desired entry
              * @return the tree entry; NULL if not found
              */
@@ -81,11 +118,60 @@ namespace LibQGit2
 
             /**
              * Lookup a tree entry by its position in the tree
+             *
+             * The returned entry keeps this tree alive.
+             *
              * @param idx the position in the entry list
              * @return the tree entry; NULL if not found
              */
             TreeEntry entryByIndex(int idx) const;
 
+            /**
+             * Copies the data of all the entries of this tree, in order.
+             */
+            QVector<TreeEntryInfo> entryInfos() const;
+
+            /**
+             * Lookup a tree entry by its path relative to this tree, descending into
+             * subtrees as needed.
+             *
+             * The returned entry owns its data, so it stays valid after this tree and the
+             * intermediate subtrees are gone.
+             *
+             * @param path the path of the desired entry, e.g. "src/qgittree.cpp"
+             * @return the tree entry; NULL if not found
+             * @throws LibQGit2::Exception
+             */
+            TreeEntry entryByPath(const QString& path) const;
+
+            /**
+             * Lookup several tree entries by their paths relative to this tree.
+             *
+             * This is equivalent to calling entryByPath() for each path, except that each
+             * intermediate subtree is looked up only once for all the paths sharing it.
+             *
+             * @param paths the paths of the desired entries
+             * @return the tree entries in the order of \a paths; NULL entries for the paths
+             * that are not found
+             * @throws LibQGit2::Exception
+             */
+            QList<TreeEntry> entriesByPaths(const QStringList& paths) const;
+
+            /**
+             * Recursively visits all the entries of this tree and its subtrees.
+             *
+             * Subtrees are loaded from the object database only as needed, so returning
+             * \c WalkSkipSubtree for a subtree entry in \c PreOrder mode avoids reading
+             * anything below it.
+             *
+             * Exceptions thrown from \a callback stop the walk and are propagated to the caller.
+             *
+             * @param mode the traversal order
+             * @param callback called for each entry
+             * @throws LibQGit2::Exception
+             */
+            void walk(WalkMode mode, const WalkCallback &callback) const;
+
             git_tree* data() const;
             const git_tree* constData() const;
     };
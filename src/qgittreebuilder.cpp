@@ -0,0 +1,78 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "qgittreebuilder.h"
+#include "qgitrepository.h"
+#include "qgitoid.h"
+#include "qgitexception.h"
+
+#include "private/pathcodec.h"
+
+namespace LibQGit2
+{
+
+TreeBuilder::TreeBuilder(const Repository &repo, const Tree &source)
+{
+    git_treebuilder *builder = 0;
+    qGitThrow(git_treebuilder_new(&builder, repo.data(), source.constData()));
+    d = QSharedPointer<git_treebuilder>(builder, git_treebuilder_free);
+}
+
+void TreeBuilder::insert(const QString &fileName, const OId &oid, FileMode mode)
+{
+    qGitThrow(git_treebuilder_insert(NULL, data(), PathCodec::toLibGit2(fileName), oid.constData(), git_filemode_t(mode)));
+}
+
+void TreeBuilder::remove(const QString &fileName)
+{
+    qGitThrow(git_treebuilder_remove(data(), PathCodec::toLibGit2(fileName)));
+}
+
+void TreeBuilder::clear()
+{
+    git_treebuilder_clear(data());
+}
+
+TreeEntry TreeBuilder::entryByName(const QString &fileName) const
+{
+    return TreeEntry(git_treebuilder_get(data(), PathCodec::toLibGit2(fileName)));
+}
+
+size_t TreeBuilder::entryCount() const
+{
+    return git_treebuilder_entrycount(data());
+}
+
+OId TreeBuilder::write()
+{
+    git_oid oid;
+    qGitThrow(git_treebuilder_write(&oid, data()));
+    return OId(&oid);
+}
+
+git_treebuilder *TreeBuilder::data() const
+{
+    return d.data();
+}
+
+const git_treebuilder *TreeBuilder::constData() const
+{
+    return d.data();
+}
+
+}
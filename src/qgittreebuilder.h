@@ -0,0 +1,119 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_TREEBUILDER_H
+#define LIBQGIT2_TREEBUILDER_H
+
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+
+#include "git2.h"
+
+#include "libqgit2_config.h"
+#include "qgittree.h"
+#include "qgittreeentry.h"
+
+namespace LibQGit2
+{
+
+class OId;
+class Repository;
+
+/**
+ * @brief Wrapper class for git_treebuilder.
+ * Creates tree objects in memory, one level at a time, without going through an Index.
+ *
+ * Copies of a TreeBuilder share the same underlying builder.
+ *
+ * @ingroup LibQGit2
+ * @{
+ */
+class LIBQGIT2_EXPORT TreeBuilder
+{
+public:
+    /**
+     * The modes a tree entry can have.
+     */
+    enum FileMode {
+        BlobMode = GIT_FILEMODE_BLOB,
+        ExecutableMode = GIT_FILEMODE_BLOB_EXECUTABLE,
+        LinkMode = GIT_FILEMODE_LINK,
+        TreeMode = GIT_FILEMODE_TREE,
+        CommitMode = GIT_FILEMODE_COMMIT    ///< a submodule
+    };
+
+    /**
+     * Creates a TreeBuilder for \a repo, initialized with the entries of \a source
+     * unless it is null.
+     *
+     * @throws LibQGit2::Exception
+     */
+    explicit TreeBuilder(const Repository &repo, const Tree &source = Tree());
+
+    /**
+     * Adds or replaces the entry \a fileName. The object \a oid must exist in the
+     * repository and be of the type matching \a mode.
+     *
+     * @param fileName the name of the entry; may not contain slashes
+     * @throws LibQGit2::Exception
+     */
+    void insert(const QString &fileName, const OId &oid, FileMode mode = BlobMode);
+
+    /**
+     * Removes the entry \a fileName.
+     *
+     * @throws LibQGit2::Exception if there is no such entry
+     */
+    void remove(const QString &fileName);
+
+    /**
+     * Removes all the entries.
+     */
+    void clear();
+
+    /**
+     * Returns the entry \a fileName; NULL if not found. The entry is owned by this
+     * builder and is only valid until it is modified.
+     */
+    TreeEntry entryByName(const QString &fileName) const;
+
+    /**
+     * Returns the number of entries.
+     */
+    size_t entryCount() const;
+
+    /**
+     * Writes the tree to the object database.
+     *
+     * @return the id of the written tree
+     * @throws LibQGit2::Exception
+     */
+    OId write();
+
+    git_treebuilder *data() const;
+    const git_treebuilder *constData() const;
+
+private:
+    QSharedPointer<git_treebuilder> d;
+};
+
+/** @} */
+
+}
+
+#endif // LIBQGIT2_TREEBUILDER_H
@@ -21,19 +21,33 @@
 #include "qgittreeentry.h"
 #include "qgitrepository.h"
 #include "qgitexception.h"
+#include "qgittree.h"
 
+#include "private/namepool.h"
 #include "private/pathcodec.h"
 
 namespace LibQGit2
 {
 
-TreeEntry::TreeEntry(const git_tree_entry* treeEntry)
+TreeEntry::TreeEntry(const git_tree_entry* treeEntry, bool own)
     : d(treeEntry)
 {
+    if (own && treeEntry) {
+        m_owner = QSharedPointer<git_tree_entry>(const_cast<git_tree_entry*>(treeEntry), git_tree_entry_free);
+    }
+}
+
+TreeEntry::TreeEntry(const git_tree_entry* treeEntry, const Tree& parent)
+    : d(treeEntry)
+{
+    if (treeEntry) {
+        m_owner = parent.d;
+    }
 }
 
 TreeEntry::TreeEntry(const TreeEntry& other)
-    : d(other.d)
+    : d(other.d),
+      m_owner(other.m_owner)
 {
 }
 
@@ -82,4 +96,77 @@ const git_tree_entry* TreeEntry::data() const
     return d;
 }
 
+
+TreeEntryInfo::TreeEntryInfo()
+    : m_oid(),
+      m_mode(GIT_FILEMODE_UNREADABLE)
+{
+}
+
+TreeEntryInfo::TreeEntryInfo(const TreeEntry& entry)
+    : m_oid(),
+      m_mode(GIT_FILEMODE_UNREADABLE)
+{
+    if (entry.isNull()) {
+        return;
+    }
+
+    git_oid_cpy(&m_oid, git_tree_entry_id(entry.data()));
+    m_mode = git_tree_entry_filemode(entry.data());
+    m_name = internal::internName(git_tree_entry_name(entry.data()));
+}
+
+TreeEntryInfo::TreeEntryInfo(const git_tree_entry *entry, const QByteArray &name)
+    : m_mode(git_tree_entry_filemode(entry)),
+      m_name(name)
+{
+    git_oid_cpy(&m_oid, git_tree_entry_id(entry));
+}
+
+bool TreeEntryInfo::isNull() const
+{
+    return m_name.isNull();
+}
+
+unsigned int TreeEntryInfo::attributes() const
+{
+    return m_mode;
+}
+
+QString TreeEntryInfo::name() const
+{
+    return PathCodec::fromLibGit2(m_name);
+}
+
+QByteArray TreeEntryInfo::rawName() const
+{
+    return m_name;
+}
+
+OId TreeEntryInfo::oid() const
+{
+    return OId(&m_oid);
+}
+
+const git_oid* TreeEntryInfo::rawOid() const
+{
+    return &m_oid;
+}
+
+Object::Type TreeEntryInfo::type() const
+{
+    switch (m_mode) {
+    case GIT_FILEMODE_TREE:
+        return Object::TreeType;
+    case GIT_FILEMODE_BLOB:
+    case GIT_FILEMODE_BLOB_EXECUTABLE:
+    case GIT_FILEMODE_LINK:
+        return Object::BlobType;
+    case GIT_FILEMODE_COMMIT:
+        return Object::CommitType;
+    default:
+        return Object::BadType;
+    }
+}
+
 } // namespace LibQGit2
@@ -26,10 +26,13 @@
 #include "qgitobject.h"
 #include "libqgit2_config.h"
 
+#include <QtCore/QByteArray>
+
 namespace LibQGit2
 {
     class OId;
     class Repository;
+    class Tree;
 
     /**
      * @brief Wrapper class for git_tree_entry.
@@ -41,7 +44,24 @@ namespace LibQGit2
     class LIBQGIT2_EXPORT TreeEntry
     {
         public:
-            explicit TreeEntry(const git_tree_entry* treeEntry);
+            /**
+             * Creates a TreeEntry wrapping \a treeEntry.
+             *
+             * Unless \a own is true, the entry is owned by its git_tree and is only valid
+             * as long as that tree is alive. When \a own is true the entry, as returned by
+             * git_tree_entry_bypath() or git_tree_entry_dup(), becomes managed by this
+             * TreeEntry and is freed together with its last copy.
+             */
+            explicit TreeEntry(const git_tree_entry* treeEntry, bool own = false);
+
+            /**
+             * Creates a TreeEntry wrapping \a treeEntry, which belongs to \a parent.
+             *
+             * The entry holds a reference to \a parent, so it stays valid as long as any
+             * copy of it exists, even after all the Tree objects are gone.
+             */
+            TreeEntry(const git_tree_entry* treeEntry, const Tree& parent);
+
             TreeEntry(const TreeEntry& other);
             ~TreeEntry();
 
@@ -88,9 +108,78 @@ namespace LibQGit2
 
         private:
             const git_tree_entry *d;
+            // keeps d alive: either the entry itself or the tree it belongs to
+            QSharedPointer<void> m_owner;
+    };
+
+    /**
+     * @brief Compact copy of the data of a tree entry.
+     *
+     * Unlike a TreeEntry, a TreeEntryInfo doesn't refer to any libgit2 data: the id is
+     * stored inline and the name is interned, so equal names of different entries share
+     * the same memory. This makes it suitable for keeping large numbers of entries around.
+     */
+    class LIBQGIT2_EXPORT TreeEntryInfo
+    {
+        public:
+            /**
+             * Constructs a null TreeEntryInfo.
+             */
+            TreeEntryInfo();
+
+            /**
+             * Copies the data of \a entry.
+             */
+            explicit TreeEntryInfo(const TreeEntry& entry);
+
+            /**
+             * @return true when constructed from a null TreeEntry; otherwise false
+             */
+            bool isNull() const;
+
+            /**
+             * Get the UNIX file attributes of the entry
+             */
+            unsigned int attributes() const;
+
+            /**
+             * Get the filename of the entry
+             */
+            QString name() const;
+
+            /**
+             * Get the filename of the entry as stored by libgit2.
+             */
+            QByteArray rawName() const;
+
+            /**
+             * Get the id of the object pointed by the entry
+             */
+            OId oid() const;
+
+            /**
+             * Get the id of the object pointed by the entry, without copying it.
+             */
+            const git_oid* rawOid() const;
+
+            /**
+             * Get the type of the \c Object where this entry points to.
+             */
+            Object::Type type() const;
+
+        private:
+            TreeEntryInfo(const git_tree_entry *entry, const QByteArray &name);
+
+            git_oid m_oid;
+            git_filemode_t m_mode;
+            QByteArray m_name;
+
+            friend class Tree;
     };
 
     /**@}*/
 }
 
+Q_DECLARE_TYPEINFO(LibQGit2::TreeEntryInfo, Q_MOVABLE_TYPE);
+
 #endif // LIBQGIT2_TREEENTRY_H
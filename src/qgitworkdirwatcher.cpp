@@ -0,0 +1,564 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "qgitworkdirwatcher.h"
+#include "qgitrepository.h"
+#include "qgitstatuslist.h"
+#include "qgitexception.h"
+#include "qgitref.h"
+#include "qgitoid.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QPair>
+#include <QtCore/QSet>
+#include <QtCore/QSocketNotifier>
+#include <QtCore/QTimer>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace LibQGit2
+{
+
+namespace {
+
+#ifdef Q_OS_LINUX
+const uint32_t DirectoryEvents = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB
+        | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+// git replaces its files by renaming a lock file over them
+const uint32_t GitFileEvents = IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE;
+#endif
+
+}
+
+struct WorkdirWatcher::Private {
+    Private(const Repository &repo, const StatusOptions &options)
+        : repo(repo),
+          options(options),
+          workdir(repo.workDirPath()),
+          gitDir(repo.path()),
+          watchIgnored(options.statusFlags() & StatusOptions::IncludeIgnored),
+          known(false),
+          complete(true)
+    {
+    }
+
+    /**
+     * Returns true if the status of \a path was computed again by a status limited
+     * to \a hints.
+     */
+    static bool isCovered(const QString &path, const QSet<QString> &hints)
+    {
+        QString p(path);
+        if (p.endsWith('/')) {
+            // a directory reported as a whole is computed again for any path below it
+            foreach (const QString &hint, hints) {
+                if (hint.startsWith(p)) {
+                    return true;
+                }
+            }
+            p.chop(1);
+        }
+        if (hints.contains(p)) {
+            return true;
+        }
+        for (int slash = p.indexOf('/'); slash > 0; slash = p.indexOf('/', slash + 1)) {
+            if (hints.contains(p.left(slash))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static QString child(const QString &dir, const QString &name)
+    {
+        return dir.isEmpty() ? name : dir + '/' + name;
+    }
+
+    /**
+     * Returns the name of the branch HEAD points to, as "refs/heads/master", or an
+     * empty string if HEAD is detached.
+     */
+    QString headTarget() const
+    {
+        try {
+            const Reference head = repo.lookupRef("HEAD");
+            return head.isSymbolic() ? head.symbolicTarget() : QString();
+        } catch (const Exception &) {
+            return QString();
+        }
+    }
+
+    /**
+     * Returns true if HEAD resolves to another commit than at the previous call, which
+     * changes what is staged.
+     */
+    bool headMoved()
+    {
+        OId id;
+        try {
+            id = repo.lookupRef("HEAD").resolve().target();
+        } catch (const Exception &) {
+            // an unborn branch
+        }
+        const bool moved = id != head;
+        head = id;
+        return moved;
+    }
+
+    Repository repo;
+    StatusOptions options;
+    QString workdir;    // ends with a slash, as the git directory
+    QString gitDir;
+    bool watchIgnored;
+    QTimer *timer;
+    int debounceInterval;
+    QSet<QString> dirty;
+    bool known;         // false until the first update and after events were lost
+    bool complete;      // false if some directories could not be watched
+    QMap<QString, unsigned int> statuses;
+    OId head;           // the commit HEAD resolved to at the last complete update
+
+#ifdef Q_OS_LINUX
+    int fd;
+    QSocketNotifier *notifier;
+    QHash<int, QString> dirs;   // the directory of each watch, relative to the working directory
+    int gitDirWatch;
+    int headRefWatch;           // the directory of the branch HEAD points to
+    QByteArray headRefName;     // the file name of that branch in it
+
+    /**
+     * Watches the branch HEAD points to, which moves on a commit or a reset without
+     * HEAD itself being written.
+     */
+    void watchHeadRef()
+    {
+        const QString target = headTarget();
+        const int slash = target.lastIndexOf('/');
+        int wd = -1;
+        headRefName.clear();
+        if (slash > 0) {
+            wd = inotify_add_watch(fd, QFile::encodeName(gitDir + target.left(slash)).constData(), GitFileEvents);
+            headRefName = QFile::encodeName(target.mid(slash + 1));
+        }
+        if (headRefWatch >= 0 && headRefWatch != wd) {
+            inotify_rm_watch(fd, headRefWatch);
+        }
+        headRefWatch = wd;
+    }
+
+    void watch(const QString &dir)
+    {
+        const int wd = inotify_add_watch(fd, QFile::encodeName(workdir + dir).constData(), DirectoryEvents);
+        if (wd < 0) {
+            // e.g. out of watches: the changes of this directory would be missed
+            complete = false;
+            return;
+        }
+        dirs.insert(wd, dir);
+        watchSubdirectories(dir);
+    }
+
+    void unwatch(const QString &dir)
+    {
+        // a directory moved out of the working directory is still watched
+        for (QHash<int, QString>::iterator it = dirs.begin(); it != dirs.end(); ) {
+            if (it.value() == dir || it.value().startsWith(dir + '/')) {
+                inotify_rm_watch(fd, it.key());
+                it = dirs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+#else
+    QFileSystemWatcher *watcher;
+    QString headRefDir;         // the directory of the branch HEAD points to
+    QHash<QString, QSet<QString> > listings;    // the entries of each watched directory
+    QHash<QString, QPair<QDateTime, qint64> > gitFiles;
+
+    void watchHeadRef()
+    {
+        const QString target = headTarget();
+        const int slash = target.lastIndexOf('/');
+        const QString dir = slash > 0 ? QDir::cleanPath(gitDir + target.left(slash)) : QString();
+        if (dir == headRefDir) {
+            return;
+        }
+        if (!headRefDir.isEmpty()) {
+            watcher->removePath(headRefDir);
+        }
+        headRefDir = (dir.isEmpty() || !watcher->addPath(dir)) ? QString() : dir;
+    }
+
+    /**
+     * Returns true if the file \a name of the git directory was written or removed
+     * since the previous call.
+     */
+    bool gitFileChanged(const QString &name)
+    {
+        const QFileInfo info(gitDir + name);
+        const QPair<QDateTime, qint64> stamp(info.exists() ? info.lastModified() : QDateTime(), info.size());
+        const bool changed = gitFiles.value(name) != stamp;
+        gitFiles.insert(name, stamp);
+        return changed;
+    }
+
+    QSet<QString> entries(const QString &dir) const
+    {
+        return QDir(workdir + dir).entryList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System).toSet();
+    }
+
+    void watch(const QString &dir)
+    {
+        if (!watcher->addPath(workdir + dir)) {
+            complete = false;
+            return;
+        }
+        listings.insert(dir, entries(dir));
+        watchSubdirectories(dir);
+    }
+
+    void unwatch(const QString &dir)
+    {
+        for (QHash<QString, QSet<QString> >::iterator it = listings.begin(); it != listings.end(); ) {
+            if (it.key() == dir || it.key().startsWith(dir + '/')) {
+                watcher->removePath(workdir + it.key());
+                it = listings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    /**
+     * Marks what may have changed directly in \a dir: its files and the entries that
+     * appeared or disappeared. New subdirectories are watched; the existing ones
+     * report their own changes.
+     */
+    void rescan(const QString &dir)
+    {
+        const QSet<QString> before = listings.value(dir);
+        const QSet<QString> after = entries(dir);
+        listings.insert(dir, after);
+
+        foreach (const QString &name, before - after) {
+            const QString path = child(dir, name);
+            if (name != ".git") {
+                dirty.insert(path);
+                unwatch(path);
+            }
+        }
+        foreach (const QString &name, after) {
+            const QString path = child(dir, name);
+            const QFileInfo info(workdir + path);
+            if (name == ".git") {
+                continue;
+            } else if (!info.isDir() || info.isSymLink()) {
+                dirty.insert(path);
+            } else if (!before.contains(name)) {
+                dirty.insert(path);
+                if (watchIgnored || !repo.shouldIgnore(path)) {
+                    watch(path);
+                }
+            }
+        }
+    }
+#endif
+
+    void watchSubdirectories(const QString &dir)
+    {
+        const QStringList names = QDir(workdir + dir).entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::NoSymLinks);
+        foreach (const QString &name, names) {
+            const QString path = child(dir, name);
+            if (name == ".git" || (!watchIgnored && repo.shouldIgnore(path))) {
+                continue;
+            }
+            watch(path);
+        }
+    }
+};
+
+WorkdirWatcher::WorkdirWatcher(const Repository &repo, const StatusOptions &options, QObject *parent)
+    : QObject(parent),
+      d_ptr(new Private(repo, options))
+{
+    Private *d = d_ptr.data();
+    if (repo.isBare()) {
+        throw Exception("WorkdirWatcher: the repository has no working directory");
+    }
+
+    d->debounceInterval = 200;
+    d->timer = new QTimer(this);
+    d->timer->setSingleShot(true);
+    connect(d->timer, SIGNAL(timeout()), this, SLOT(update()));
+
+#ifdef Q_OS_LINUX
+    d->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (d->fd < 0) {
+        throw Exception("WorkdirWatcher: cannot initialize inotify");
+    }
+    d->notifier = new QSocketNotifier(d->fd, QSocketNotifier::Read, this);
+    connect(d->notifier, SIGNAL(activated(int)), this, SLOT(readEvents()));
+    d->gitDirWatch = inotify_add_watch(d->fd, QFile::encodeName(d->gitDir).constData(), GitFileEvents);
+    d->headRefWatch = -1;
+    d->watchHeadRef();
+    d->watch(QString());
+#else
+    d->watcher = new QFileSystemWatcher(this);
+    connect(d->watcher, SIGNAL(directoryChanged(QString)), this, SLOT(directoryChanged(QString)));
+    d->watcher->addPath(d->gitDir);
+    d->gitFileChanged("index");
+    d->gitFileChanged("HEAD");
+    d->gitFileChanged("packed-refs");
+    d->watchHeadRef();
+    d->watch(QString());
+#endif
+
+    // the first update, once the event loop runs
+    d->timer->start(0);
+}
+
+WorkdirWatcher::~WorkdirWatcher()
+{
+#ifdef Q_OS_LINUX
+    delete d_ptr->notifier;
+    ::close(d_ptr->fd);
+#endif
+}
+
+int WorkdirWatcher::debounceInterval() const
+{
+    return d_ptr->debounceInterval;
+}
+
+void WorkdirWatcher::setDebounceInterval(int msecs)
+{
+    d_ptr->debounceInterval = msecs;
+}
+
+QStringList WorkdirWatcher::paths() const
+{
+    return d_ptr->statuses.keys();
+}
+
+Status WorkdirWatcher::status(const QString &path) const
+{
+    return Status(git_status_t(d_ptr->statuses.value(path, GIT_STATUS_CURRENT)));
+}
+
+bool WorkdirWatcher::changedPaths(QStringList &paths)
+{
+    Private *d = d_ptr.data();
+    paths = d->dirty.toList();
+    d->dirty.clear();
+    const bool known = d->known && d->complete;
+    d->known = true;
+    return known;
+}
+
+void WorkdirWatcher::update()
+{
+    try {
+        updateStatus();
+    } catch (const Exception &ex) {
+        d_ptr->known = false;
+        emit updateFailed(QString::fromUtf8(ex.what()));
+    }
+}
+
+void WorkdirWatcher::updateStatus()
+{
+    Private *d = d_ptr.data();
+    d->timer->stop();
+
+    QStringList hints;
+    const bool known = changedPaths(hints);
+    if (!known) {
+        d->headMoved();
+    }
+    StatusList list = known ? d->repo.status(d->options, hints) : d->repo.parallelStatus(d->options);
+
+    QMap<QString, unsigned int> current;
+    for (const StatusEntry &entry : list) {
+        if (entry.flags() != GIT_STATUS_CURRENT) {
+            current.insert(entry.path(), entry.flags());
+        }
+    }
+
+    QMap<QString, unsigned int> statuses;
+    if (!known) {
+        statuses = current;
+    } else {
+        // merge the paths computed again into the previous status
+        const QSet<QString> covered = hints.toSet();
+        for (QMap<QString, unsigned int>::const_iterator it = d->statuses.constBegin(); it != d->statuses.constEnd(); ++it) {
+            if (!current.contains(it.key()) && !Private::isCovered(it.key(), covered)) {
+                statuses.insert(it.key(), it.value());
+            }
+        }
+        for (QMap<QString, unsigned int>::const_iterator it = current.constBegin(); it != current.constEnd(); ++it) {
+            statuses.insert(it.key(), it.value());
+        }
+    }
+
+    QStringList changed;
+    for (QMap<QString, unsigned int>::const_iterator it = d->statuses.constBegin(); it != d->statuses.constEnd(); ++it) {
+        if (statuses.value(it.key(), GIT_STATUS_CURRENT) != it.value()) {
+            changed.append(it.key());
+        }
+    }
+    for (QMap<QString, unsigned int>::const_iterator it = statuses.constBegin(); it != statuses.constEnd(); ++it) {
+        if (!d->statuses.contains(it.key())) {
+            changed.append(it.key());
+        }
+    }
+
+    d->statuses = statuses;
+    if (!changed.isEmpty()) {
+        changed.sort();
+        emit statusChanged(changed);
+    }
+}
+
+void WorkdirWatcher::readEvents()
+{
+#ifdef Q_OS_LINUX
+    Private *d = d_ptr.data();
+    alignas(struct inotify_event) char buffer[16 * 1024];
+    ssize_t length;
+    while ((length = ::read(d->fd, buffer, sizeof(buffer))) > 0) {
+        for (const char *p = buffer; p < buffer + length; ) {
+            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(p);
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                d->known = false;
+                continue;
+            }
+            if (event->wd == d->gitDirWatch) {
+                if (event->len == 0) {
+                    continue;
+                }
+                if (qstrcmp(event->name, "index") == 0) {
+                    // the working directory is compared with other entries now,
+                    // e.g. after a reset: any path may differ
+                    d->known = false;
+                } else if (qstrcmp(event->name, "HEAD") == 0) {
+                    // HEAD may point to another branch
+                    d->watchHeadRef();
+                } else if (qstrcmp(event->name, "packed-refs") != 0) {
+                    continue;
+                }
+                if (d->headMoved()) {
+                    // what is staged is only compared for the hinted paths
+                    d->known = false;
+                }
+            } else if (event->wd == d->headRefWatch) {
+                if (event->mask & IN_IGNORED) {
+                    d->headRefWatch = -1;
+                    continue;
+                }
+                if (event->len == 0 || d->headRefName != event->name) {
+                    continue;
+                }
+                if (d->headMoved()) {
+                    d->known = false;
+                }
+            } else {
+                QHash<int, QString>::const_iterator dir = d->dirs.constFind(event->wd);
+                if (dir == d->dirs.constEnd()) {
+                    continue;
+                }
+                if (event->mask & IN_IGNORED) {
+                    d->dirs.remove(event->wd);
+                    continue;
+                }
+                if (event->len == 0) {
+                    continue;
+                }
+
+                const QString path = Private::child(dir.value(), QFile::decodeName(event->name));
+                if (path == ".git") {
+                    continue;
+                }
+                d->dirty.insert(path);
+                if (event->mask & IN_ISDIR) {
+                    if (event->mask & (IN_MOVED_FROM | IN_DELETE)) {
+                        d->unwatch(path);
+                    } else if ((event->mask & (IN_CREATE | IN_MOVED_TO))
+                               && (d->watchIgnored || !d->repo.shouldIgnore(path))) {
+                        d->watch(path);
+                    }
+                }
+            }
+            d->timer->start(d->debounceInterval);
+        }
+    }
+#endif
+}
+
+void WorkdirWatcher::directoryChanged(const QString &path)
+{
+#ifndef Q_OS_LINUX
+    Private *d = d_ptr.data();
+    const QString cleanPath = QDir::cleanPath(path);
+    if (cleanPath == QDir::cleanPath(d->gitDir)) {
+        // git writes many files here; only the index and the refs matter
+        bool changed = false;
+        if (d->gitFileChanged("index")) {
+            // the working directory is compared with other entries now
+            d->known = false;
+            changed = true;
+        }
+        if (d->gitFileChanged("HEAD")) {
+            d->watchHeadRef();
+            changed = true;
+        }
+        changed |= d->gitFileChanged("packed-refs");
+        if (!changed) {
+            return;
+        }
+        if (d->headMoved()) {
+            d->known = false;
+        }
+    } else if (cleanPath == d->headRefDir) {
+        if (d->headMoved()) {
+            d->known = false;
+        }
+    } else if (cleanPath == QDir::cleanPath(d->workdir)) {
+        d->rescan(QString());
+    } else {
+        d->rescan(cleanPath.mid(d->workdir.size()));
+    }
+    d->timer->start(d->debounceInterval);
+#else
+    Q_UNUSED(path);
+#endif
+}
+
+}
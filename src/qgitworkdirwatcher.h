@@ -0,0 +1,149 @@
+/******************************************************************************
+ * This file is part of the libqgit2 library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef LIBQGIT2_WORKDIRWATCHER_H
+#define LIBQGIT2_WORKDIRWATCHER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QStringList>
+
+#include "libqgit2_config.h"
+#include "qgitchangehintprovider.h"
+#include "qgitstatus.h"
+#include "qgitstatusoptions.h"
+
+namespace LibQGit2
+{
+
+class Repository;
+
+/**
+ * @brief Keeps the status of a working directory up to date by watching it.
+ *
+ * A WorkdirWatcher watches the directories of the working directory, and the index,
+ * HEAD, the branch HEAD points to and the packed refs of the repository, for changes.
+ * On Linux it uses inotify directly, which scales to many directories; elsewhere it
+ * uses QFileSystemWatcher, and a changed directory marks the files directly in it. Ignored directories are not watched unless the status
+ * options include ignored files.
+ *
+ * The paths reported by the file system are collected until no event arrived for
+ * debounceInterval() milliseconds. Then the status is computed for those paths only,
+ * with Repository::status(const StatusOptions &, const QStringList &), merged into
+ * the status kept by the watcher, and statusChanged() is emitted with the paths whose
+ * status changed. The first update, any update after events were lost and any update
+ * after the index was written or HEAD moved to another commit, e.g. by a reset, scan
+ * the whole working directory with Repository::parallelStatus(), since the comparison
+ * of HEAD with the index is limited to the hinted paths as well.
+ *
+ * The status is kept per path rather than as a StatusList, since it is combined from
+ * the results of many partial status computations. Renames are not detected.
+ *
+ * A WorkdirWatcher is also a ChangeHintProvider, so it can feed another status
+ * computation instead; both uses should not be combined.
+ *
+ * @ingroup LibQGit2
+ * @{
+ */
+class LIBQGIT2_EXPORT WorkdirWatcher : public QObject, public ChangeHintProvider
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Starts watching the working directory of \a repo. The status is first computed
+     * when the event loop runs, or when update() or updateStatus() is called.
+     *
+     * @param options the options of the status computations
+     * @throws LibQGit2::Exception
+     */
+    explicit WorkdirWatcher(const Repository &repo,
+                            const StatusOptions &options = StatusOptions(StatusOptions::ShowIndexAndWorkdir, StatusOptions::IncludeUntracked),
+                            QObject *parent = 0);
+    ~WorkdirWatcher();
+
+    /**
+     * Returns how long the watcher waits after an event for other events before it
+     * updates the status, in milliseconds. The default is 200.
+     */
+    int debounceInterval() const;
+
+    /**
+     * Sets how long the watcher waits after an event for other events before it
+     * updates the status.
+     */
+    void setDebounceInterval(int msecs);
+
+    /**
+     * Returns the paths that are not current, in path order. Untracked and ignored
+     * directories that are reported as a whole end with a slash.
+     */
+    QStringList paths() const;
+
+    /**
+     * Returns the status of \a path; a current Status if it has no pending change.
+     */
+    Status status(const QString &path) const;
+
+    /**
+     * Returns the paths that changed since the previous call, for use as a
+     * ChangeHintProvider. This is called by updateStatus().
+     */
+    bool changedPaths(QStringList &paths);
+
+    /**
+     * Updates the status now with the changes collected so far.
+     *
+     * @throws LibQGit2::Exception
+     */
+    void updateStatus();
+
+public slots:
+    /**
+     * Updates the status now with the changes collected so far, like updateStatus(),
+     * but emits updateFailed() instead of throwing.
+     */
+    void update();
+
+signals:
+    /**
+     * Emitted after an update with the paths whose status changed, including those
+     * that became current.
+     */
+    void statusChanged(const QStringList &paths);
+
+    /**
+     * Emitted when update() failed, e.g. when it was triggered by the file system.
+     * The next update scans the whole working directory.
+     */
+    void updateFailed(const QString &message);
+
+private slots:
+    void readEvents();
+    void directoryChanged(const QString &path);
+
+private:
+    struct Private;
+    QScopedPointer<Private> d_ptr;
+};
+
+/** @} */
+
+}
+
+#endif // LIBQGIT2_WORKDIRWATCHER_H
@@ -21,9 +21,20 @@
 #include "TestHelpers.h"
 #include "qgitrepository.h"
 #include "qgittree.h"
+#include "qgittreeentry.h"
 #include "qgitdiff.h"
 #include "qgitdiffdelta.h"
 #include "qgitdifffile.h"
+#include "qgitstatcache.h"
+#include "qgitindexentry.h"
+#include "qgitstatuslist.h"
+#include "qgitstatusoptions.h"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
 
 using namespace LibQGit2;
 
@@ -33,6 +44,13 @@ class TestDiff : public TestBase
 
 private slots:
     void testDiffFileList();
+    void testDiffIndexAndWorkdir();
+    void testWritePatch();
+    void testStatCacheKeepsIndexInMemory();
+    void testApplyToTree();
+    void testApplyBinary();
+    void testApplyToWorkdir();
+    void testFailedApplyChangesNothing();
 };
 
 
@@ -57,6 +75,461 @@ void TestDiff::testDiffFileList()
     }
 }
 
+void TestDiff::testDiffIndexAndWorkdir()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+
+        const QString fileName("CMakeLists.txt");
+        QFile file(testdir + "/" + fileName);
+        const qint64 indexedSize = file.size();
+        QVERIFY(indexedSize > 0);
+        QVERIFY(file.open(QIODevice::Append));
+        file.write("# changed in the working directory\n");
+        file.close();
+
+        StatCache cache(repo);
+        Tree headTree = repo.lookupRevision("HEAD^{tree}").toTree();
+
+        Diff workdirDiff = repo.diffIndexToWorkdir(Index(), cache);
+        QCOMPARE(workdirDiff.numDeltas(), size_t(1));
+        QCOMPARE(workdirDiff.delta(0).newFile().path(), fileName);
+
+        const DiffFile oldFile = workdirDiff.delta(0).oldFile();
+        QVERIFY(oldFile.flags().testFlag(DiffFile::ValidId));
+        QCOMPARE(oldFile.oid(), headTree.entryByName(fileName).oid());
+        QCOMPARE(QString::fromUtf8(oldFile.rawPath()), fileName);
+        QCOMPARE(oldFile.size(), indexedSize);
+        QCOMPARE(oldFile.mode(), unsigned(GIT_FILEMODE_BLOB));
+
+        const DiffFile newFile = workdirDiff.delta(0).newFile();
+        QCOMPARE(newFile.size(), QFileInfo(file).size());
+        QCOMPARE(newFile.mode(), unsigned(GIT_FILEMODE_BLOB));
+
+        QCOMPARE(workdirDiff.toBuffer(Diff::NameOnly), QByteArray("CMakeLists.txt\n"));
+        QVERIFY(workdirDiff.toBuffer(Diff::Patch).contains("\n+# changed in the working directory\n"));
+        QCOMPARE(repo.diffTreeToWorkdir(headTree, true, cache).numDeltas(), size_t(1));
+        QCOMPARE(repo.diffTreeToIndex(headTree).numDeltas(), size_t(0));
+
+        Index index = repo.index();
+        index.addByPath(fileName);
+        QCOMPARE(repo.diffTreeToIndex(headTree, index).numDeltas(), size_t(1));
+        QCOMPARE(repo.diffIndexToWorkdir(index, cache).numDeltas(), size_t(0));
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+static QByteArray readFile(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+static bool writeFile(const QString &path, const QByteArray &content)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(content) == content.size();
+}
+
+/**
+ * A device that fails once more than its capacity was written to it.
+ */
+class FullDevice : public QIODevice
+{
+public:
+    explicit FullDevice(qint64 capacity) : m_free(capacity)
+    {
+        setErrorString("the device is full");
+    }
+
+protected:
+    qint64 readData(char *, qint64) { return -1; }
+
+    qint64 writeData(const char *, qint64 length)
+    {
+        if (length > m_free) {
+            return -1;
+        }
+        m_free -= length;
+        return length;
+    }
+
+private:
+    qint64 m_free;
+};
+
+// the text libgit2 prints itself for the diff
+static QByteArray printedByLibgit2(const Diff &diff, Diff::Format format)
+{
+    git_buf buf = GIT_BUF_INIT_CONST(NULL, 0);
+    qGitThrow(git_diff_to_buf(&buf, diff.d.data(), git_diff_format_t(format)));
+    const QByteArray text(buf.ptr, int(buf.size));
+    git_buf_free(&buf);
+    return text;
+}
+
+void TestDiff::testWritePatch()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+
+        // a large file, and a line longer than the buffer of writePatch()
+        QByteArray large;
+        for (int i = 0; i < 5000; ++i) {
+            large += QString("line %1 of a large file\n").arg(i).toLatin1();
+        }
+        QFile largeFile(testdir + "/large.txt");
+        QVERIFY(largeFile.open(QIODevice::WriteOnly));
+        largeFile.write(large);
+        largeFile.close();
+        QFile longFile(testdir + "/long.txt");
+        QVERIFY(longFile.open(QIODevice::WriteOnly));
+        longFile.write(QByteArray(100 * 1024, 'x') + "\n");
+        longFile.close();
+
+        Index index = repo.index();
+        index.addByPath("large.txt");
+        index.addByPath("long.txt");
+        const Diff diff = repo.diffTreeToIndex(repo.lookupRevision("HEAD^{tree}").toTree(), index);
+        QCOMPARE(diff.numDeltas(), size_t(2));
+
+        const QList<Diff::Format> formats = QList<Diff::Format>() << Diff::Patch << Diff::PatchHeader
+                << Diff::Raw << Diff::NameOnly << Diff::NameStatus;
+        foreach (Diff::Format format, formats) {
+            QFile output(testdir + "/output.patch");
+            QVERIFY(output.open(QIODevice::WriteOnly | QIODevice::Truncate));
+            diff.writePatch(&output, format);
+            output.close();
+            QCOMPARE(readFile(output.fileName()), printedByLibgit2(diff, format));
+        }
+
+        // the patch is larger than the buffer
+        QFile output(testdir + "/output.patch");
+        QVERIFY(output.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        diff.writePatch(&output);
+        output.close();
+        QVERIFY(output.size() > 2 * 64 * 1024);
+        QVERIFY(readFile(output.fileName()).contains("+line 4999 of a large file\n"));
+        QCOMPARE(diff.toBuffer(Diff::NameStatus), QByteArray("A\tlarge.txt\nA\tlong.txt\n"));
+
+        QBuffer closed;
+        EXPECT_THROW(diff.writePatch(&closed), Exception);
+        QFile readOnly(testdir + "/large.txt");
+        QVERIFY(readOnly.open(QIODevice::ReadOnly));
+        EXPECT_THROW(diff.writePatch(&readOnly), Exception);
+
+        // the device fails while the buffer is flushed
+        FullDevice full(1024);
+        QVERIFY(full.open(QIODevice::WriteOnly));
+        try {
+            diff.writePatch(&full);
+            QFAIL("writing to a full device didn't throw");
+        } catch (const Exception &ex) {
+            QVERIFY(QString::fromUtf8(ex.what()).contains("the device is full"));
+        }
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+static unsigned int statusOf(const StatusList &list, const QString &path)
+{
+    for (const StatusEntry &entry : list) {
+        if (entry.path() == path) {
+            return entry.flags();
+        }
+    }
+    return GIT_STATUS_CURRENT;
+}
+
+void TestDiff::testStatCacheKeepsIndexInMemory()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+
+        const QString indexPath = testdir + "/.git/index";
+        QVERIFY(QFile::copy(indexPath, testdir + "/other-index"));
+        const QByteArray indexData = readFile(indexPath);
+        QVERIFY(!indexData.isEmpty());
+
+        // same content, new stat data
+        const QString touched("COPYING");
+        const QByteArray content = readFile(testdir + "/" + touched);
+        QFile touchedFile(testdir + "/" + touched);
+        QVERIFY(touchedFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        touchedFile.write(content);
+        touchedFile.close();
+
+        const QString staged("CMakeLists.txt");
+        QFile stagedFile(testdir + "/" + staged);
+        QVERIFY(stagedFile.open(QIODevice::Append));
+        stagedFile.write("# staged, not written\n");
+        stagedFile.close();
+
+        StatCache cache(repo);
+        cache.index().addByPath(staged);
+
+        const StatusOptions options;
+        const StatusList status = repo.status(options, cache);
+        QCOMPARE(statusOf(status, touched), unsigned(GIT_STATUS_CURRENT));
+        QCOMPARE(statusOf(status, staged), unsigned(GIT_STATUS_INDEX_MODIFIED));
+        // the repository's own index was not involved
+        QCOMPARE(statusOf(repo.status(options), staged), unsigned(GIT_STATUS_WT_MODIFIED));
+
+        Tree headTree = repo.lookupRevision("HEAD^{tree}").toTree();
+        QCOMPARE(repo.diffIndexToWorkdir(Index(), cache).numDeltas(), size_t(0));
+        QCOMPARE(repo.diffTreeToWorkdir(headTree, true, cache).numDeltas(), size_t(1));
+
+        // neither the refreshed stat data nor the staged change reached the disk
+        QCOMPARE(readFile(indexPath), indexData);
+
+        // the cache's own index is used, not the repository's
+        Index other;
+        other.open(testdir + "/other-index");
+        StatCache otherCache(other);
+        QCOMPARE(statusOf(repo.status(options, otherCache), staged), unsigned(GIT_STATUS_WT_MODIFIED));
+        QCOMPARE(repo.diffIndexToWorkdir(Index(), otherCache).numDeltas(), size_t(1));
+        QCOMPARE(statusOf(repo.status(options, cache), staged), unsigned(GIT_STATUS_INDEX_MODIFIED));
+        QCOMPARE(readFile(indexPath), indexData);
+
+        // the stat data is refreshed when the cache loads the index and on refresh(),
+        // not by every operation
+        sleep::ms(1100);
+        const QString rewritten("README.md");
+        QVERIFY(writeFile(testdir + "/" + rewritten, readFile(testdir + "/" + rewritten)));
+        const qint64 mtime = QFileInfo(testdir + "/" + rewritten).lastModified().toMSecsSinceEpoch() / 1000;
+        Index cached = cache.index();
+        const int position = cached.find(rewritten);
+        QVERIFY(position >= 0);
+        QVERIFY(qint64(cached.getByIndex(position).mtime().seconds) != mtime);
+        QCOMPARE(statusOf(repo.status(options, cache), rewritten), unsigned(GIT_STATUS_CURRENT));
+        QVERIFY(qint64(cached.getByIndex(position).mtime().seconds) != mtime);
+        cache.refresh();
+        QCOMPARE(qint64(cached.getByIndex(position).mtime().seconds), mtime);
+        QCOMPARE(statusOf(repo.status(options, cache), staged), unsigned(GIT_STATUS_INDEX_MODIFIED));
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestDiff::testApplyToTree()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+
+        const QString fileName("CMakeLists.txt");
+        QFile file(testdir + "/" + fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QByteArray content = file.readAll();
+        file.close();
+
+        content.replace("libqgit2", "libqgit2 patched");
+        content.append("# appended in the working directory\n");
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(content);
+        file.close();
+
+        Tree headTree = repo.lookupRevision("HEAD^{tree}").toTree();
+        Index patched = repo.applyToTree(headTree, repo.diffIndexToWorkdir());
+        const int pos = patched.find(fileName);
+        QVERIFY(pos >= 0);
+        QCOMPARE(patched.getByIndex(pos).id(), repo.createBlobFromBuffer(content));
+
+        QList<OId> trees = repo.applySeriesToTree(headTree, QList<Diff>() << repo.diffIndexToWorkdir());
+        QCOMPARE(trees.size(), 1);
+        QCOMPARE(trees.first(), patched.createTree(repo));
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+static int collectBinaryType(const git_diff_delta *, const git_diff_binary *binary, void *payload)
+{
+    static_cast<QSet<int>*>(payload)->insert(binary->new_file.type);
+    return 0;
+}
+
+static OId hashBlob(const QByteArray &content)
+{
+    git_oid id;
+    git_odb_hash(&id, content.constData(), size_t(content.size()), GIT_OBJ_BLOB);
+    return OId(&id);
+}
+
+void TestDiff::testApplyBinary()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+
+        QByteArray large;
+        for (int i = 0; i < 8192; ++i) {
+            large.append(char((i * 7) % 251));
+        }
+        const QByteArray small("\0\1\2\3", 4);
+        QVERIFY(writeFile(testdir + "/large.bin", large));
+        QVERIFY(writeFile(testdir + "/small.bin", small));
+        Index index = repo.index();
+        index.addByPath("large.bin");
+        index.addByPath("small.bin");
+        index.write();
+
+        // a small change to a large file makes a delta, a rewrite of a small one a literal
+        QByteArray largeChanged = large;
+        largeChanged[100] = 'x';
+        largeChanged.append("tail");
+        QByteArray smallChanged;
+        for (int i = 0; i < 64; ++i) {
+            smallChanged.append(char((i * 151 + 17) % 256));
+        }
+        QVERIFY(writeFile(testdir + "/large.bin", largeChanged));
+        QVERIFY(writeFile(testdir + "/small.bin", smallChanged));
+
+        git_diff_options opts = GIT_DIFF_OPTIONS_INIT;
+        opts.flags = GIT_DIFF_SHOW_BINARY;
+        git_diff *rawDiff = 0;
+        QCOMPARE(git_diff_index_to_workdir(&rawDiff, repo.data(), index.data(), &opts), 0);
+        Diff diff(rawDiff);
+        QCOMPARE(diff.numDeltas(), size_t(2));
+
+        QSet<int> types;
+        QCOMPARE(git_diff_foreach(rawDiff, NULL, collectBinaryType, NULL, NULL, &types), 0);
+        QVERIFY(types.contains(GIT_DIFF_BINARY_DELTA));
+        QVERIFY(types.contains(GIT_DIFF_BINARY_LITERAL));
+
+        // the postimages are not in the object database, so the binary data is applied
+        QVERIFY(writeFile(testdir + "/large.bin", large));
+        QVERIFY(writeFile(testdir + "/small.bin", small));
+        repo.applyToWorkdir(diff);
+        QCOMPARE(readFile(testdir + "/large.bin"), largeChanged);
+        QCOMPARE(readFile(testdir + "/small.bin"), smallChanged);
+
+        repo.applyToIndex(index, diff);
+        QCOMPARE(index.getByIndex(index.find("large.bin")).id(), hashBlob(largeChanged));
+        QCOMPARE(index.getByIndex(index.find("small.bin")).id(), hashBlob(smallChanged));
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestDiff::testApplyToWorkdir()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+
+        const QByteArray copying = readFile(testdir + "/COPYING");
+        const QByteArray cmake = readFile(testdir + "/CMakeLists.txt");
+        const QByteArray cmakeChanged = QByteArray(cmake).replace("libqgit2", "libqgit2 patched");
+        QVERIFY(cmakeChanged != cmake);
+
+        // rename, delete and modify in the index, then diff it with HEAD
+        Index index = repo.index();
+        QVERIFY(writeFile(testdir + "/COPYING.moved", copying));
+        QVERIFY(writeFile(testdir + "/CMakeLists.txt", cmakeChanged));
+        index.addByPath("COPYING.moved");
+        index.addByPath("CMakeLists.txt");
+        index.remove("COPYING", 0);
+        index.remove("README.md", 0);
+
+        Tree headTree = repo.lookupRevision("HEAD^{tree}").toTree();
+        git_diff *rawDiff = 0;
+        QCOMPARE(git_diff_tree_to_index(&rawDiff, repo.data(), headTree.data(), index.data(), NULL), 0);
+        Diff diff(rawDiff);
+        git_diff_find_options findOpts = GIT_DIFF_FIND_OPTIONS_INIT;
+        findOpts.flags = GIT_DIFF_FIND_RENAMES;
+        QCOMPARE(git_diff_find_similar(rawDiff, &findOpts), 0);
+        QCOMPARE(diff.numDeltas(), size_t(3));
+
+        QVERIFY(QFile::remove(testdir + "/COPYING.moved"));
+        QVERIFY(writeFile(testdir + "/CMakeLists.txt", cmake));
+
+        repo.applyToWorkdir(diff);
+        QVERIFY(!QFile::exists(testdir + "/COPYING"));
+        QCOMPARE(readFile(testdir + "/COPYING.moved"), copying);
+        QVERIFY(!QFile::exists(testdir + "/README.md"));
+        QCOMPARE(readFile(testdir + "/CMakeLists.txt"), cmakeChanged);
+
+        // nothing left to rename or delete
+        EXPECT_THROW(repo.applyToWorkdir(diff), Exception);
+        QCOMPARE(readFile(testdir + "/COPYING.moved"), copying);
+        QCOMPARE(readFile(testdir + "/CMakeLists.txt"), cmakeChanged);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestDiff::testFailedApplyChangesNothing()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+
+        const QByteArray readme = readFile(testdir + "/README.md");
+        const QByteArray cmake = readFile(testdir + "/CMakeLists.txt");
+        const QByteArray cmakeChanged = cmake + "# appended\n";
+
+        QVERIFY(writeFile(testdir + "/CMakeLists.txt", cmakeChanged));
+        QVERIFY(QFile::remove(testdir + "/README.md"));
+        const Diff diff = repo.diffIndexToWorkdir();
+        QCOMPARE(diff.numDeltas(), size_t(2));
+
+        // the deletion doesn't match: the modification, earlier in the patch, is not written
+        QVERIFY(writeFile(testdir + "/CMakeLists.txt", cmake));
+        QVERIFY(writeFile(testdir + "/README.md", readme + "changed\n"));
+        EXPECT_THROW(repo.applyToWorkdir(diff), Exception);
+        QCOMPARE(readFile(testdir + "/CMakeLists.txt"), cmake);
+        QVERIFY(QFile::exists(testdir + "/README.md"));
+
+        // the hunk doesn't apply: the deletion, later in the patch, doesn't happen
+        QVERIFY(writeFile(testdir + "/CMakeLists.txt", "conflicting\n"));
+        QVERIFY(writeFile(testdir + "/README.md", readme));
+        EXPECT_THROW(repo.applyToWorkdir(diff), Exception);
+        QCOMPARE(readFile(testdir + "/README.md"), readme);
+
+        // the same for an index missing the deleted file
+        Index index = repo.index();
+        const OId cmakeId = index.getByIndex(index.find("CMakeLists.txt")).id();
+        index.remove("README.md", 0);
+        const unsigned int count = index.entryCount();
+        EXPECT_THROW(repo.applyToIndex(index, diff), Exception);
+        QCOMPARE(index.entryCount(), count);
+        QCOMPARE(index.getByIndex(index.find("CMakeLists.txt")).id(), cmakeId);
+
+        // nor is the postimage stored, until the whole patch applies
+        git_odb *odb = 0;
+        qGitThrow(git_repository_odb(&odb, repo.data()));
+        QSharedPointer<git_odb> odbPtr(odb, git_odb_free);
+        const OId cmakeChangedId = hashBlob(cmakeChanged);
+        QVERIFY(!git_odb_exists(odb, cmakeChangedId.constData()));
+        index.read(true);
+        repo.applyToIndex(index, diff);
+        QCOMPARE(index.getByIndex(index.find("CMakeLists.txt")).id(), cmakeChangedId);
+        QVERIFY(git_odb_exists(odb, cmakeChangedId.constData()));
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
 QTEST_MAIN(TestDiff)
 
 #include "Diff.moc"
@@ -0,0 +1,698 @@
+/******************************************************************************
+* Permission to use, copy, modify, and distribute the software
+* and its documentation for any purpose and without fee is hereby
+* granted, provided that the above copyright notice appear in all
+* copies and that both that the copyright notice and this
+* permission notice and warranty disclaimer appear in supporting
+* documentation, and that the name of the author not be used in
+* advertising or publicity pertaining to distribution of the
+* software without specific, written prior permission.
+*
+* The author disclaim all warranties with regard to this
+* software, including all implied warranties of merchantability
+* and fitness.  In no event shall the author be liable for any
+* special, indirect or consequential damages or any damages
+* whatsoever resulting from loss of use, data or profits, whether
+* in an action of contract, negligence or other tortious action,
+* arising out of or in connection with the use or performance of
+* this software.
+*/
+
+#include "TestHelpers.h"
+#include "qgitrepository.h"
+#include "qgitconflictiterator.h"
+#include "qgitindex.h"
+#include "qgitindexentry.h"
+#include "qgitindexmodel.h"
+#include "qgitstatuslist.h"
+#include "qgitstatusoptions.h"
+
+#include "git2/sys/index.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+
+#include <string.h>
+
+using namespace LibQGit2;
+
+class TestIndex : public TestBase
+{
+    Q_OBJECT
+
+private slots:
+    void testRefresh();
+    void testAddByPaths();
+    void testAddAll();
+    void testAddManyByPaths();
+    void testAddLargeBatch();
+    void testParallelManyFiles();
+    void testIterator();
+    void testFind();
+    void testFindPrefixIgnoringCase();
+    void testVersion();
+    void testModel();
+    void testModelIgnoringCase();
+    void testConflicts();
+};
+
+static int positionOf(const Index &index, const QString &path)
+{
+    for (unsigned int i = 0; i < index.entryCount(); ++i) {
+        if (index.getByIndex(i).path() == path) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void TestIndex::testRefresh()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+        Index index = repo.index();
+
+        QVERIFY(index.refresh().isEmpty());
+
+        QFile file(testdir + "/CMakeLists.txt");
+        QVERIFY(file.open(QIODevice::Append));
+        file.write("# changed in the working directory\n");
+        file.close();
+        QVERIFY(QFile::remove(testdir + "/COPYING"));
+
+        // limited to the pathspec
+        QVERIFY(index.refresh(QStringList() << "src/*").isEmpty());
+
+        QStringList changed = index.refresh(QStringList(), 4);
+        changed.sort();
+        QCOMPARE(changed, QStringList() << "CMakeLists.txt" << "COPYING");
+        QCOMPARE(positionOf(index, "COPYING"), -1);
+
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const OId blob = repo.createBlobFromBuffer(file.readAll());
+        QCOMPARE(index.getByIndex(positionOf(index, "CMakeLists.txt")).id(), blob);
+
+        QVERIFY(index.refresh().isEmpty());
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestIndex::testAddByPaths()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+        Index index = repo.index();
+        const unsigned int count = index.entryCount();
+
+        // enough files to have the index rebuilt
+        QStringList paths;
+        QVERIFY(QDir(testdir).mkdir("batch"));
+        for (int i = 0; i < 100; ++i) {
+            const QString path = QString("batch/file%1.txt").arg(i, 3, 10, QChar('0'));
+            QFile file(testdir + "/" + path);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(QString("content of %1\n").arg(i).toUtf8());
+            paths.prepend(path);
+        }
+
+        QFile modified(testdir + "/CMakeLists.txt");
+        QVERIFY(modified.open(QIODevice::Append));
+        modified.write("# changed in the working directory\n");
+        modified.close();
+        paths.append("CMakeLists.txt");
+
+        index.addByPaths(paths, 4);
+        QCOMPARE(index.entryCount(), count + 100);
+
+        const int position = positionOf(index, "batch/file042.txt");
+        QVERIFY(position >= 0);
+        QCOMPARE(index.getByIndex(position).id(), repo.createBlobFromBuffer("content of 42\n"));
+        QCOMPARE(index.getByIndex(position + 1).path(), QString("batch/file043.txt"));
+
+        QVERIFY(modified.open(QIODevice::ReadOnly));
+        QCOMPARE(index.getByIndex(positionOf(index, "CMakeLists.txt")).id(), repo.createBlobFromBuffer(modified.readAll()));
+
+        QVERIFY(index.refresh().isEmpty());
+
+        EXPECT_THROW(index.addByPaths(QStringList() << "no/such/file"), Exception);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestIndex::testAddAll()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+        Index index = repo.index();
+
+        QFile file(testdir + "/untracked.txt");
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("untracked\n");
+        file.close();
+        QVERIFY(QFile::remove(testdir + "/COPYING"));
+
+        // limited to the pathspec
+        index.addAll(QStringList() << "src/*");
+        QCOMPARE(positionOf(index, "untracked.txt"), -1);
+        QVERIFY(positionOf(index, "COPYING") >= 0);
+
+        index.addAll();
+        QCOMPARE(positionOf(index, "COPYING"), -1);
+        const int position = positionOf(index, "untracked.txt");
+        QVERIFY(position >= 0);
+        QCOMPARE(index.getByIndex(position).id(), repo.createBlobFromBuffer("untracked\n"));
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+static bool writeFile(const QString &path, const QByteArray &content)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(content) == content.size();
+}
+
+void TestIndex::testAddManyByPaths()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+        Index index = repo.index();
+
+        QVERIFY(QDir(testdir).mkpath("olddir"));
+        QVERIFY(writeFile(testdir + "/olddir/a.txt", "a\n"));
+        QVERIFY(writeFile(testdir + "/olddir/b.txt", "b\n"));
+        index.addByPaths(QStringList() << "olddir/a.txt" << "olddir/b.txt");
+        const unsigned int count = index.entryCount();
+
+        // a directory replaces a file, and a file a directory, among many new entries
+        QStringList paths;
+        QVERIFY(QDir(testdir).mkpath("bulk"));
+        for (int i = 0; i < 100; ++i) {
+            const QString path = QString("bulk/%1.txt").arg(i);
+            QVERIFY(writeFile(testdir + "/" + path, QByteArray::number(i)));
+            paths << path;
+        }
+        QVERIFY(QFile::remove(testdir + "/COPYING"));
+        QVERIFY(QDir(testdir).mkpath("COPYING"));
+        QVERIFY(writeFile(testdir + "/COPYING/inside.txt", "inside\n"));
+        QVERIFY(QDir(testdir + "/olddir").removeRecursively());
+        QVERIFY(writeFile(testdir + "/olddir", "now a file\n"));
+        paths << "COPYING/inside.txt" << "olddir";
+
+        index.addByPaths(paths, 4);
+        QCOMPARE(index.entryCount(), count + 100 + 2 - 1 - 2);
+        QCOMPARE(index.find("COPYING"), -1);
+        QCOMPARE(index.find("olddir/a.txt"), -1);
+        QCOMPARE(index.find("olddir/b.txt"), -1);
+        QCOMPARE(index.getByIndex(index.find("olddir")).id(), repo.createBlobFromBuffer("now a file\n"));
+        QCOMPARE(index.getByIndex(index.find("COPYING/inside.txt")).id(), repo.createBlobFromBuffer("inside\n"));
+        QCOMPARE(index.getByIndex(index.find("bulk/42.txt")).id(), repo.createBlobFromBuffer("42"));
+
+        // still sorted
+        for (unsigned int i = 1; i < index.entryCount(); ++i) {
+            QVERIFY(strcmp(index.getByIndex(i - 1).rawPath(), index.getByIndex(i).rawPath()) < 0);
+        }
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+static int countObject(const git_oid *, void *payload)
+{
+    ++*static_cast<int*>(payload);
+    return 0;
+}
+
+static int objectCount(const Repository &repo)
+{
+    git_odb *odb = 0;
+    qGitThrow(git_repository_odb(&odb, repo.data()));
+    int count = 0;
+    const int error = git_odb_foreach(odb, &countObject, &count);
+    git_odb_free(odb);
+    qGitThrow(error);
+    return count;
+}
+
+void TestIndex::testAddLargeBatch()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+        Index index = repo.index();
+        const unsigned int count = index.entryCount();
+
+        // many files sharing a few contents
+        const int files = 3000;
+        const int contents = 10;
+        QStringList paths;
+        QVERIFY(QDir(testdir).mkpath("large"));
+        for (int i = 0; i < files; ++i) {
+            const QString path = QString("large/file%1.txt").arg(i, 4, 10, QChar('0'));
+            QVERIFY(writeFile(testdir + "/" + path, "shared content " + QByteArray::number(i % contents) + "\n"));
+            paths << path;
+        }
+
+        const int objects = objectCount(repo);
+        index.addByPaths(paths, 4);
+        QCOMPARE(index.entryCount(), count + files);
+        // each distinct content is written once
+        QCOMPARE(objectCount(repo), objects + contents);
+        QCOMPARE(index.getByIndex(index.find("large/file2997.txt")).id(), repo.createBlobFromBuffer("shared content 7\n"));
+        for (unsigned int i = 1; i < index.entryCount(); ++i) {
+            QVERIFY(strcmp(index.getByIndex(i - 1).rawPath(), index.getByIndex(i).rawPath()) < 0);
+        }
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+// more than one chunk of the parallel loops, so several threads do the work
+static const int ManyFilesCount = 600;
+
+static QString manyFilePath(int i)
+{
+    return QString("many/file%1.txt").arg(i, 3, 10, QChar('0'));
+}
+
+static QByteArray manyFileContent(int i, const QByteArray &suffix = QByteArray())
+{
+    return QByteArray::number(i) + "\n" + suffix;
+}
+
+static QStringList statusSummary(const StatusList &list)
+{
+    QStringList summary;
+    for (const StatusEntry &entry : list) {
+        summary << QString("%1 %2").arg(entry.path()).arg(entry.flags());
+    }
+    summary.sort();
+    return summary;
+}
+
+void TestIndex::testParallelManyFiles()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+        Index index = repo.index();
+
+        QVERIFY(QDir(testdir).mkpath("many"));
+        for (int i = 0; i < ManyFilesCount; ++i) {
+            QFile file(testdir + "/" + manyFilePath(i));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write(manyFileContent(i));
+        }
+
+        index.addAll(QStringList(), 4);
+        for (int i = 0; i < ManyFilesCount; ++i) {
+            const QByteArray content = manyFileContent(i);
+            git_oid expected;
+            QCOMPARE(git_odb_hash(&expected, content.constData(), size_t(content.size()), GIT_OBJ_BLOB), 0);
+            const int position = index.find(manyFilePath(i));
+            QVERIFY(position >= 0);
+            QCOMPARE(index.getByIndex(position).id(), OId(&expected));
+        }
+        index.write();
+
+        QStringList modified;
+        for (int i = 0; i < ManyFilesCount; i += 3) {
+            QFile file(testdir + "/" + manyFilePath(i));
+            QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+            file.write(manyFileContent(i, "modified\n"));
+            modified << manyFilePath(i);
+        }
+        QStringList changed = index.refresh(QStringList(), 4);
+        changed.sort();
+        QCOMPARE(changed, modified);
+        index.write();
+
+        // the parallel scan finds the same changes as libgit2
+        for (int i = 1; i < ManyFilesCount; i += 7) {
+            QFile file(testdir + "/" + manyFilePath(i));
+            QVERIFY(file.open(QIODevice::Append));
+            file.write("changed again\n");
+        }
+        for (int i = 2; i < ManyFilesCount; i += 50) {
+            QVERIFY(QFile::remove(testdir + "/" + manyFilePath(i)));
+        }
+        const StatusOptions options(StatusOptions::ShowIndexAndWorkdir, StatusOptions::IncludeUntracked);
+        const QStringList expected = statusSummary(repo.status(options));
+        QVERIFY(expected.size() > ManyFilesCount / 7);
+        QCOMPARE(statusSummary(repo.parallelStatus(options, 4)), expected);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestIndex::testIterator()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+        Index index = repo.index();
+
+        unsigned int count = 0;
+        for (const IndexEntry &entry : index) {
+            const IndexEntry expected = index.getByIndex(count++);
+            QVERIFY(entry.rawPath() == expected.rawPath());
+            QVERIFY(git_oid_equal(entry.rawOid(), &expected.data()->id));
+        }
+        QCOMPARE(count, index.entryCount());
+        QCOMPARE(unsigned(index.end() - index.begin()), count);
+
+        const IndexEntry entry = *index.begin();
+        QCOMPARE(QString(entry.rawPath()), entry.path());
+        QCOMPARE(entry.mode(), unsigned(GIT_FILEMODE_BLOB));
+        QVERIFY(entry.mtime().seconds > 0);
+        QVERIFY(entry.ctime().seconds > 0);
+        QVERIFY(entry.ino() != 0);
+        QCOMPARE(entry.stage(), 0);
+        QCOMPARE(entry.extendedFlags(), 0u);
+        QCOMPARE(index.begin()->path(), entry.path());
+        QCOMPARE((index.begin() + 1)->path(), index.getByIndex(1).path());
+
+        QVERIFY(index.getByIndex(count).isNull());
+        QVERIFY(Index().begin() == Index().end());
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestIndex::testFind()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+        Index index = repo.index();
+
+        QCOMPARE(index.find("CMakeLists.txt"), positionOf(index, "CMakeLists.txt"));
+        QCOMPARE(index.find("no/such/file"), -1);
+
+        QStringList expected;
+        for (const IndexEntry &entry : index) {
+            if (entry.path().startsWith("src/")) {
+                expected << entry.path();
+            }
+        }
+        QVERIFY(!expected.isEmpty());
+
+        QStringList found;
+        for (const IndexEntry &entry : index.findPrefix("src")) {
+            found << entry.path();
+        }
+        QCOMPARE(found, expected);
+        QCOMPARE(index.findPrefix("src/").size(), expected.size());
+
+        QVERIFY(index.findPrefix("sr").isEmpty());
+        QVERIFY(index.findPrefix("no/such/dir").isEmpty());
+        QCOMPARE(unsigned(index.findPrefix(QString()).size()), index.entryCount());
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+static void addBlobEntry(git_index *index, const QByteArray &path)
+{
+    git_oid id;
+    qGitThrow(git_odb_hash(&id, "content\n", 8, GIT_OBJ_BLOB));
+    git_index_entry entry;
+    memset(&entry, 0, sizeof(git_index_entry));
+    entry.path = path.constData();
+    entry.mode = GIT_FILEMODE_BLOB;
+    git_oid_cpy(&entry.id, &id);
+    qGitThrow(git_index_add(index, &entry));
+}
+
+/**
+ * Returns an in-memory index ignoring case, with an entry for each of \a paths.
+ * Their UTF-8 lead bytes sort differently if Latin-1 letters are folded as well.
+ */
+static Index caseInsensitiveIndex(const QList<QByteArray> &paths)
+{
+    git_index *raw = NULL;
+    qGitThrow(git_index_new(&raw));
+    Index index(raw);
+    qGitThrow(git_index_set_caps(raw, GIT_INDEXCAP_IGNORE_CASE));
+
+    foreach (const QByteArray &path, paths) {
+        addBlobEntry(raw, path);
+    }
+    return index;
+}
+
+void TestIndex::testFindPrefixIgnoringCase()
+{
+    try {
+        // e-acute (C3 A9) sorts before the euro sign (E2 82 AC) in libgit2
+        const Index index = caseInsensitiveIndex(QList<QByteArray>()
+                << "a/file" << "\xC3\xA9/file" << "\xE2\x82\xAC/first" << "\xE2\x82\xAC/second" << "B/file");
+        QCOMPARE(index.entryCount(), 5u);
+        QCOMPARE(QByteArray(index.getByIndex(1).rawPath()), QByteArray("B/file"));
+
+        const Index::Range eacute = index.findPrefix(QString::fromUtf8("\xC3\xA9"));
+        QCOMPARE(eacute.size(), 1);
+        QCOMPARE(QByteArray(eacute.begin()->rawPath()), QByteArray("\xC3\xA9/file"));
+        QCOMPARE(index.findPrefix(QString::fromUtf8("\xE2\x82\xAC")).size(), 2);
+        QCOMPARE(index.findPrefix("b").size(), 1);
+        QCOMPARE(index.findPrefix("A").size(), 1);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestIndex::testVersion()
+{
+#if LIBGIT2_VER_MAJOR == 0 && LIBGIT2_VER_MINOR < 26
+    SKIPTEST("index versions require libgit2 0.26");
+#else
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+        Index index = repo.index();
+        const unsigned int count = index.entryCount();
+        const int position = positionOf(index, "CMakeLists.txt");
+        const OId id = index.getByIndex(position).id();
+
+        index.setVersion(4);
+        index.write();
+
+        Index reread;
+        reread.open(testdir + "/.git/index");
+        QCOMPARE(reread.version(), 4u);
+        QCOMPARE(reread.entryCount(), count);
+        QCOMPARE(reread.getByIndex(position).path(), QString("CMakeLists.txt"));
+        QCOMPARE(reread.getByIndex(position).id(), id);
+
+        EXPECT_THROW(index.setVersion(1), Exception);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+#endif
+}
+
+void TestIndex::testModel()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+        Index index = repo.index();
+        IndexModel model(index);
+
+        QCOMPARE(unsigned(model.rowCount(QModelIndex())), index.entryCount());
+        const int row = positionOf(index, "CMakeLists.txt");
+        QCOMPARE(model.data(model.index(row), Qt::DisplayRole).toString(), QString("CMakeLists.txt"));
+        QCOMPARE(model.data(model.index(row), IndexModel::OIdRole).toString(),
+                 QString::fromLatin1(index.getByIndex(row).id().format()));
+        QCOMPARE(model.data(model.index(row), IndexModel::StageRole).toInt(), 0);
+        QCOMPARE(model.data(model.index(row), IndexModel::StatusRole).toInt(), int(IndexModel::Normal));
+
+        QSignalSpy inserted(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+        QSignalSpy removed(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+        QSignalSpy changed(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+        QSignalSpy reset(&model, SIGNAL(modelReset()));
+
+        QFile file(testdir + "/CMakeLists.txt");
+        QVERIFY(file.open(QIODevice::Append));
+        file.write("# changed in the working directory\n");
+        file.close();
+        QFile added(testdir + "/added.txt");
+        QVERIFY(added.open(QIODevice::WriteOnly));
+        added.write("added\n");
+        added.close();
+
+        index.addByPaths(QStringList() << "CMakeLists.txt" << "added.txt");
+        index.remove("COPYING", 0);
+        model.refresh(false);
+
+        QCOMPARE(inserted.count(), 1);
+        QCOMPARE(removed.count(), 1);
+        QCOMPARE(changed.count(), 1);
+        QCOMPARE(reset.count(), 0);
+        QCOMPARE(changed.at(0).at(0).value<QModelIndex>().row(), positionOf(index, "CMakeLists.txt"));
+
+        QCOMPARE(unsigned(model.rowCount(QModelIndex())), index.entryCount());
+        for (int i = 0; i < model.rowCount(QModelIndex()); ++i) {
+            QCOMPARE(model.data(model.index(i), IndexModel::PathRole).toString(), index.getByIndex(i).path());
+        }
+
+        // nothing changed
+        model.refresh();
+        QCOMPARE(inserted.count() + removed.count() + changed.count(), 3);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestIndex::testModelIgnoringCase()
+{
+    try {
+        Index index = caseInsensitiveIndex(QList<QByteArray>()
+                << "a/file" << "\xC3\xA9/file" << "\xE2\x82\xAC/first" << "\xE2\x82\xAC/second");
+        IndexModel model(index);
+        QCOMPARE(model.rowCount(QModelIndex()), 4);
+
+        QSignalSpy inserted(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+        QSignalSpy removed(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+        addBlobEntry(index.data(), "\xC3\xA9/new");
+        model.refresh(false);
+
+        QCOMPARE(inserted.count(), 1);
+        QCOMPARE(inserted.at(0).at(1).toInt(), 2);
+        QCOMPARE(removed.count(), 0);
+        QCOMPARE(model.rowCount(QModelIndex()), 5);
+        for (int i = 0; i < model.rowCount(QModelIndex()); ++i) {
+            QCOMPARE(model.data(model.index(i), IndexModel::PathRole).toString(), index.getByIndex(i).path());
+        }
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestIndex::testConflicts()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+        Index index = repo.index();
+        const unsigned int count = index.entryCount();
+
+        const OId base = repo.createBlobFromBuffer("base\n");
+        const OId ours = repo.createBlobFromBuffer("ours\n");
+        const OId theirs = repo.createBlobFromBuffer("theirs\n");
+        for (int i = 0; i < 3; ++i) {
+            const QByteArray path = "conflict" + QByteArray::number(i);
+            git_index_entry stages[3];
+            const OId ids[3] = { base, ours, theirs };
+            for (int stage = 0; stage < 3; ++stage) {
+                memset(&stages[stage], 0, sizeof(git_index_entry));
+                stages[stage].path = path.constData();
+                stages[stage].mode = GIT_FILEMODE_BLOB;
+                git_oid_cpy(&stages[stage].id, ids[stage].constData());
+            }
+            // the second one was added on both sides
+            qGitThrow(git_index_conflict_add(index.data(), i == 1 ? NULL : &stages[0], &stages[1], &stages[2]));
+        }
+        QVERIFY(index.hasConflicts());
+
+        QStringList paths;
+        ConflictIterator it(index);
+        while (it.next()) {
+            paths << it.path();
+            QCOMPARE(it.ancestor().isNull(), it.path() == "conflict1");
+            QCOMPARE(it.ours().id(), ours);
+            QCOMPARE(it.theirs().id(), theirs);
+            QCOMPARE(it.theirs().stage(), 3);
+        }
+        QCOMPARE(paths, QStringList() << "conflict0" << "conflict1" << "conflict2");
+
+        QMap<QString, OId> resolutions;
+        resolutions["conflict0"] = ours;
+        resolutions["conflict1"] = OId();
+        QMap<QString, OId> invalid(resolutions);
+        invalid["CMakeLists.txt"] = ours;
+        EXPECT_THROW(index.resolveConflicts(invalid), Exception);
+        QCOMPARE(index.entryCount(), count + 8);
+
+        // a missing blob is found before anything is resolved
+        QMap<QString, OId> missingBlob(resolutions);
+        missingBlob["conflict2"] = OId::stringToOid("0123456789abcdef0123456789abcdef01234567");
+        EXPECT_THROW(index.resolveConflicts(missingBlob), Exception);
+        QCOMPARE(index.entryCount(), count + 8);
+        QCOMPARE(git_index_reuc_entrycount(index.data()), size_t(0));
+
+        index.resolveConflicts(resolutions);
+        QVERIFY(index.hasConflicts());
+        QCOMPARE(index.entryCount(), count + 4);
+        QCOMPARE(index.getByIndex(index.find("conflict0")).id(), ours);
+        QCOMPARE(index.getByIndex(index.find("conflict0")).stage(), 0);
+        QCOMPARE(index.find("conflict1"), -1);
+        QCOMPARE(git_index_reuc_entrycount(index.data()), size_t(2));
+
+        ConflictIterator remaining(index);
+        QVERIFY(remaining.next());
+        QCOMPARE(remaining.path(), QString("conflict2"));
+        QVERIFY(!remaining.next());
+
+        // an index without a repository, as returned by Repository::mergeTrees()
+        git_index *raw = NULL;
+        qGitThrow(git_index_new(&raw));
+        Index inMemory(raw);
+        git_index_entry stages[2];
+        const OId sides[2] = { ours, theirs };
+        for (int side = 0; side < 2; ++side) {
+            memset(&stages[side], 0, sizeof(git_index_entry));
+            stages[side].path = "conflict";
+            stages[side].mode = GIT_FILEMODE_BLOB;
+            git_oid_cpy(&stages[side].id, sides[side].constData());
+        }
+        qGitThrow(git_index_conflict_add(raw, NULL, &stages[0], &stages[1]));
+
+        QMap<QString, OId> inMemoryResolution;
+        inMemoryResolution["conflict"] = OId::stringToOid("0123456789abcdef0123456789abcdef01234567");
+        EXPECT_THROW(inMemory.resolveConflicts(inMemoryResolution), Exception);
+        EXPECT_THROW(inMemory.resolveConflicts(inMemoryResolution, repo), Exception);
+        QCOMPARE(inMemory.entryCount(), 2u);
+
+        inMemoryResolution["conflict"] = theirs;
+        EXPECT_THROW(inMemory.resolveConflicts(inMemoryResolution), Exception);
+        inMemory.resolveConflicts(inMemoryResolution, repo);
+        QVERIFY(!inMemory.hasConflicts());
+        QCOMPARE(inMemory.getByIndex(0).id(), theirs);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+QTEST_MAIN(TestIndex);
+
+#include "Index.moc"
@@ -21,10 +21,18 @@
 #include "TestHelpers.h"
 
 #include "qgitrepository.h"
+#include "qgitchangehintprovider.h"
+#include "qgitrepositorypool.h"
+#include "qgitreferenceiterator.h"
+#include "qgitreftransaction.h"
 #include "qgitremote.h"
+#include "qgitworkdirwatcher.h"
 
 #include <QPointer>
 #include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QThread>
 
 using namespace LibQGit2;
 
@@ -46,6 +54,20 @@ private slots:
     void testDeleteBranch();
     void testShouldIgnore();
     void testIdentitySetting();
+    void testRepositoryPool();
+    void testDiscoverAndOpenCached();
+    void testDiscoverAndOpenCachedRelative();
+    void testReferenceIterator();
+    void testRefTransaction();
+    void testRefSnapshot();
+    void testListTagsPeeled();
+    void testHintedStatus();
+    void testWorkdirWatcher();
+    void testWorkdirWatcherIndexAndHead();
+    void testWorkdirWatcherUpdateFailure();
+    void testStatusListSummary();
+    void benchmarkCreateRefs();
+    void benchmarkCreateRefsInTransaction();
 
 private:
     const QString branchName;
@@ -155,6 +177,641 @@ void TestRepository::testIdentitySetting()
     QCOMPARE(repo->identity(), id);
 }
 
+/**
+ * Releases a pool handle from another thread, after a while.
+ */
+class HandleReleaser : public QThread
+{
+public:
+    explicit HandleReleaser(RepositoryPool::Handle &handle) : m_handle(handle) {}
+
+protected:
+    void run()
+    {
+        sleep::ms(50);
+        m_handle.release();
+    }
+
+private:
+    RepositoryPool::Handle &m_handle;
+};
+
+void TestRepository::testRepositoryPool()
+{
+    try {
+        RepositoryPool pool(2, 0);
+        {
+            RepositoryPool::Handle first = pool.acquire(ExistingRepository);
+            RepositoryPool::Handle second = pool.acquire(ExistingRepository);
+            QVERIFY(first->data() != second->data());
+            QVERIFY(!second.repository().isHeadUnborn());
+
+            EXPECT_THROW(pool.acquire(ExistingRepository, 10), Exception);
+
+            RepositoryPool::Statistics stats = pool.statistics();
+            QCOMPARE(stats.open, 2);
+            QCOMPARE(stats.inUse, 2);
+            QCOMPARE(stats.timedOut, quint64(1));
+
+            git_repository *released = first->data();
+            first.release();
+            QVERIFY(first.isNull());
+
+            RepositoryPool::Handle third = pool.acquire(ExistingRepository, 10);
+            QCOMPARE(third->data(), released);
+
+            RepositoryPool::Handle moved(std::move(third));
+            QVERIFY(third.isNull());
+            QVERIFY(!moved.isNull());
+
+            // without a timeout, acquire() waits until another thread releases a handle
+            git_repository *releasedLater = second->data();
+            HandleReleaser releaser(second);
+            releaser.start();
+            RepositoryPool::Handle fourth = pool.acquire(ExistingRepository);
+            QVERIFY(releaser.wait());
+            QVERIFY(second.isNull());
+            QCOMPARE(fourth->data(), releasedLater);
+        }
+
+        RepositoryPool::Statistics stats = pool.statistics();
+        QCOMPARE(stats.inUse, 0);
+        QCOMPARE(stats.peakInUse, 2);
+        QCOMPARE(stats.opened, quint64(2));
+        QCOMPARE(stats.acquired, quint64(4));
+        QCOMPARE(stats.waited, quint64(2));
+        QCOMPARE(stats.timedOut, quint64(1));
+
+        sleep::ms(5);
+        pool.evictIdle();
+        stats = pool.statistics();
+        QCOMPARE(stats.open, 0);
+        QCOMPARE(stats.evicted, quint64(2));
+
+        EXPECT_THROW(pool.acquire(testdir + "/missing"), Exception);
+        QCOMPARE(pool.statistics().open, 0);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestRepository::testDiscoverAndOpenCached()
+{
+    try {
+        const QString startPath(testdir + "/a/b");
+        QVERIFY(QDir().mkpath(startPath));
+        Repository::clearDiscoveryCache();
+
+        Repository().init(testdir);
+        repo->discoverAndOpenCached(startPath);
+        QCOMPARE(QDir(repo->path()).canonicalPath(), QDir(testdir + "/.git").canonicalPath());
+
+        Repository other;
+        other.discoverAndOpenCached(startPath);
+        QCOMPARE(other.path(), repo->path());
+
+        // a stale entry is discovered again
+        QVERIFY(removeDir(testdir + "/.git"));
+        Repository().init(testdir + "/a");
+        other.discoverAndOpenCached(startPath);
+        QCOMPARE(QDir(other.path()).canonicalPath(), QDir(testdir + "/a/.git").canonicalPath());
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestRepository::testDiscoverAndOpenCachedRelative()
+{
+    // restores the current directory however the test ends
+    struct CurrentDirectory {
+        QString path;
+        ~CurrentDirectory() { QDir::setCurrent(path); }
+    } current = { QDir::currentPath() };
+
+    try {
+        QVERIFY(QDir().mkpath(testdir + "/first/sub"));
+        QVERIFY(QDir().mkpath(testdir + "/second/sub"));
+        Repository::clearDiscoveryCache();
+        Repository().init(testdir + "/first");
+        Repository().init(testdir + "/second");
+
+        QVERIFY(QDir::setCurrent(testdir + "/first"));
+        repo->discoverAndOpenCached("sub");
+        QCOMPARE(QDir(repo->path()).canonicalPath(), QDir(testdir + "/first/.git").canonicalPath());
+
+        // the same relative path names another directory now
+        QVERIFY(QDir::setCurrent(testdir + "/second"));
+        Repository other;
+        other.discoverAndOpenCached("sub");
+        QCOMPARE(QDir(other.path()).canonicalPath(), QDir(testdir + "/second/.git").canonicalPath());
+
+        // an equivalent spelling finds the same repository
+        Repository same;
+        same.discoverAndOpenCached(testdir + "/second/./sub/");
+        QCOMPARE(QDir(same.path()).canonicalPath(), QDir(other.path()).canonicalPath());
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestRepository::testReferenceIterator()
+{
+    try {
+        repo->open(ExistingRepository);
+
+        QStringList names;
+        ReferenceIterator all(*repo);
+        while (all.next()) {
+            names << all.name();
+            if (all.isSymbolic()) {
+                QVERIFY(!all.rawTarget());
+                QVERIFY(all.rawSymbolicTarget());
+            } else {
+                QCOMPARE(all.target(), repo->lookupRefOId(all.name()));
+            }
+        }
+        QVERIFY(!all.next());
+
+        QStringList expected = repo->listReferences();
+        names.sort();
+        expected.sort();
+        QCOMPARE(names, expected);
+
+        ReferenceIterator heads(*repo, "refs/heads/*");
+        int count = 0;
+        while (heads.next()) {
+            QVERIFY(qstrncmp(heads.rawName(), "refs/heads/", 11) == 0);
+            QCOMPARE(heads.reference().name(), heads.name());
+            ++count;
+        }
+        QCOMPARE(count, expected.filter(QRegExp("^refs/heads/")).size());
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestRepository::testRefTransaction()
+{
+    initTestRepo();
+
+    try {
+        repo->open(testdir);
+        const OId head = repo->head().target();
+
+        {
+            RefTransaction tx(*repo);
+            tx.lockRefs(QStringList() << "refs/heads/tx1" << "refs/heads/tx2");
+            tx.setTarget("refs/heads/tx1", head, "created in a transaction");
+            tx.setSymbolicTarget("refs/heads/tx2", "refs/heads/tx1");
+            EXPECT_THROW(tx.setTarget("refs/heads/unlocked", head), Exception);
+            // not committed
+        }
+        EXPECT_THROW(repo->lookupRef("refs/heads/tx1"), Exception);
+
+        RefTransaction tx(*repo);
+        tx.lockRefs(QStringList() << "refs/heads/tx1" << "refs/heads/tx2");
+        tx.setTarget("refs/heads/tx1", head, "created in a transaction");
+        tx.setSymbolicTarget("refs/heads/tx2", "refs/heads/tx1");
+
+        RefTransaction concurrent(*repo);
+        EXPECT_THROW(concurrent.lockRef("refs/heads/tx1"), Exception);
+
+        tx.commit();
+        QCOMPARE(repo->lookupRefOId("refs/heads/tx1"), head);
+        QCOMPARE(repo->lookupRef("refs/heads/tx2").symbolicTarget(), QString("refs/heads/tx1"));
+
+        RefTransaction removal(*repo);
+        removal.lockRef("refs/heads/tx2");
+        removal.remove("refs/heads/tx2");
+        removal.commit();
+        EXPECT_THROW(repo->lookupRef("refs/heads/tx2"), Exception);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestRepository::testRefSnapshot()
+{
+    initTestRepo();
+
+    try {
+        repo->open(testdir);
+        QVERIFY(!repo->isRefSnapshotEnabled());
+        repo->setRefSnapshotEnabled(true);
+        QVERIFY(repo->isRefSnapshotEnabled());
+
+        const OId head = repo->lookupRefOId("HEAD");
+        QCOMPARE(head, repo->head().target());
+        QCOMPARE(repo->lookupRefOId("HEAD"), head);
+        EXPECT_THROW(repo->lookupRefOId("refs/heads/missing"), Exception);
+
+        // updates made behind the snapshot's back are seen
+        const OId parent = repo->lookupCommit(head).parentId(0);
+        Repository other;
+        other.open(testdir);
+        other.createRef(repo->head().name(), parent);
+        QCOMPARE(repo->lookupRefOId("HEAD"), parent);
+
+        repo->setRefSnapshotEnabled(false);
+        QCOMPARE(repo->lookupRefOId("HEAD"), parent);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestRepository::testListTagsPeeled()
+{
+    initTestRepo();
+
+    try {
+        repo->open(testdir);
+        const Commit head = repo->lookupCommit(repo->head().target());
+        const OId light = repo->createTag("peel-light", head);
+        const OId annotated = repo->createTag("peel-annotated", head, Signature("tagger", "tagger@example.com"), "annotated");
+        QVERIFY(annotated != head.oid());
+
+        QList<Repository::TagInfo> tags = repo->listTagsPeeled("peel-*");
+        QCOMPARE(tags.size(), 2);
+        foreach (const Repository::TagInfo &tag, tags) {
+            QCOMPARE(tag.target, head.oid());
+            if (tag.name == "peel-light") {
+                QCOMPARE(tag.oid, light);
+            } else {
+                QCOMPARE(tag.name, QString("peel-annotated"));
+                QCOMPARE(tag.oid, annotated);
+            }
+        }
+
+        QStringList names;
+        foreach (const Repository::TagInfo &tag, repo->listTagsPeeled()) {
+            names << tag.name;
+        }
+        QStringList expected = repo->listTags();
+        names.sort();
+        expected.sort();
+        QCOMPARE(names, expected);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+class FixedHints : public ChangeHintProvider
+{
+public:
+    FixedHints(bool known, const QStringList &paths) : m_known(known), m_paths(paths), m_calls(0) {}
+
+    void reset(bool known, const QStringList &paths)
+    {
+        m_known = known;
+        m_paths = paths;
+    }
+
+    int calls() const { return m_calls; }
+
+    bool changedPaths(QStringList &paths)
+    {
+        ++m_calls;
+        paths = m_paths;
+        return m_known;
+    }
+
+private:
+    bool m_known;
+    QStringList m_paths;
+    int m_calls;
+};
+
+static QStringList statusSummary(const StatusList &list)
+{
+    QStringList summary;
+    for (const StatusEntry &entry : list) {
+        summary << QString("%1 %2").arg(entry.path()).arg(entry.flags());
+    }
+    summary.sort();
+    return summary;
+}
+
+void TestRepository::testHintedStatus()
+{
+    initTestRepo();
+
+    try {
+        repo->open(testdir);
+
+        QFile modified(testdir + "/CMakeLists.txt");
+        QVERIFY(modified.open(QIODevice::ReadOnly));
+        const QByteArray original = modified.readAll();
+        modified.close();
+        QVERIFY(modified.open(QIODevice::Append));
+        modified.write("# changed in the working directory\n");
+        modified.close();
+        QVERIFY(QFile::remove(testdir + "/COPYING"));
+        QVERIFY(QDir(testdir).mkpath("newdir"));
+        QFile untracked(testdir + "/newdir/a.txt");
+        QVERIFY(untracked.open(QIODevice::WriteOnly));
+        untracked.close();
+        QFile staged(testdir + "/staged.txt");
+        QVERIFY(staged.open(QIODevice::WriteOnly));
+        staged.write("staged\n");
+        staged.close();
+        Index index = repo->index();
+        index.addByPath("staged.txt");
+        index.write();
+
+        const StatusOptions options(StatusOptions::ShowIndexAndWorkdir, StatusOptions::IncludeUntracked);
+        const QStringList full = statusSummary(repo->status(options));
+        QCOMPARE(full.size(), 4);
+
+        QCOMPARE(statusSummary(repo->parallelStatus(options, 4)), full);
+
+        FixedHints unknown(false, QStringList());
+        QCOMPARE(statusSummary(repo->status(options, unknown)), full);
+
+        // HEAD is only compared with the index for the hinted paths as well
+        FixedHints hints(true, QStringList() << "CMakeLists.txt" << "newdir");
+        const QStringList hinted = statusSummary(repo->status(options, hints));
+        QCOMPARE(hinted.size(), 2);
+        QVERIFY(hinted.filter("COPYING").isEmpty());
+        QVERIFY(hinted.filter("staged.txt").isEmpty());
+
+        const QStringList stagedOnly = statusSummary(repo->status(options, QStringList() << "staged.txt"));
+        QCOMPARE(stagedOnly.size(), 1);
+        QVERIFY(!stagedOnly.filter("staged.txt").isEmpty());
+
+        QCOMPARE(statusSummary(repo->status(options, QStringList())).size(), 0);
+
+        // what was found changed is checked again until it is current
+        FixedHints sequence(false, QStringList());
+        QCOMPARE(statusSummary(repo->status(options, sequence)), full);
+        sequence.reset(true, QStringList());
+        QCOMPARE(statusSummary(repo->status(options, sequence)), full);
+
+        QVERIFY(modified.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        modified.write(original);
+        modified.close();
+        sequence.reset(true, QStringList() << "CMakeLists.txt");
+        const QStringList reverted = statusSummary(repo->status(options, sequence));
+        QCOMPARE(reverted.size(), 3);
+        QVERIFY(reverted.filter("CMakeLists.txt").isEmpty());
+
+        sequence.reset(true, QStringList());
+        QCOMPARE(statusSummary(repo->status(options, sequence)), reverted);
+        QCOMPARE(sequence.calls(), 4);
+
+        // the pending paths belong to the Repository that computed them
+        Repository other;
+        other.open(testdir);
+        sequence.reset(true, QStringList());
+        QCOMPARE(statusSummary(other.status(options, sequence)).size(), 0);
+        sequence.reset(true, QStringList());
+        QCOMPARE(statusSummary(repo->status(options, sequence)), reverted);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestRepository::testWorkdirWatcher()
+{
+    initTestRepo();
+
+    try {
+        repo->open(testdir);
+        WorkdirWatcher watcher(*repo);
+        watcher.setDebounceInterval(50);
+        QSignalSpy spy(&watcher, SIGNAL(statusChanged(QStringList)));
+        watcher.update();
+        QVERIFY(watcher.paths().isEmpty());
+
+        QFile modified(testdir + "/CMakeLists.txt");
+        QVERIFY(modified.open(QIODevice::Append));
+        modified.write("# changed in the working directory\n");
+        modified.close();
+        QFile added(testdir + "/added.txt");
+        QVERIFY(added.open(QIODevice::WriteOnly));
+        added.close();
+
+        QVERIFY(spy.wait(5000));
+        while (spy.wait(500)) {
+        }
+        QCOMPARE(watcher.paths(), QStringList() << "CMakeLists.txt" << "added.txt");
+        QVERIFY(watcher.status("CMakeLists.txt").isModifiedInWorkdir());
+        QVERIFY(watcher.status("added.txt").isNewInWorkdir());
+        QVERIFY(watcher.status("COPYING").isCurrent());
+
+        spy.clear();
+        QVERIFY(QFile::remove(testdir + "/added.txt"));
+        QVERIFY(spy.wait(5000));
+        QCOMPARE(spy.last().at(0).toStringList(), QStringList() << "added.txt");
+        QCOMPARE(watcher.paths(), QStringList() << "CMakeLists.txt");
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestRepository::testWorkdirWatcherIndexAndHead()
+{
+    initTestRepo();
+
+    try {
+        repo->open(testdir);
+        const StatusOptions options(StatusOptions::ShowIndexAndWorkdir, StatusOptions::IncludeUntracked);
+        WorkdirWatcher watcher(*repo, options);
+        watcher.setDebounceInterval(50);
+        QSignalSpy spy(&watcher, SIGNAL(statusChanged(QStringList)));
+        watcher.update();
+
+        // waits until the watcher caught up, then compares it with a full status
+        auto verifyWatcher = [&]() -> bool {
+            if (!spy.wait(5000)) {
+                return false;
+            }
+            while (spy.wait(500)) {
+            }
+            spy.clear();
+            QStringList paths;
+            for (const StatusEntry &entry : repo->status(options)) {
+                if (entry.flags() != GIT_STATUS_CURRENT) {
+                    paths << entry.path();
+                    if (watcher.status(entry.path()).data() != entry.flags()) {
+                        return false;
+                    }
+                }
+            }
+            paths.sort();
+            return watcher.paths() == paths;
+        };
+
+        const Object head = repo->lookupRevision("HEAD");
+        const Object parent = repo->lookupRevision("HEAD~1");
+
+        QFile modified(testdir + "/CMakeLists.txt");
+        QVERIFY(modified.open(QIODevice::Append));
+        modified.write("# changed in the working directory\n");
+        modified.close();
+        QVERIFY(verifyWatcher());
+        QVERIFY(watcher.status("CMakeLists.txt").isModifiedInWorkdir());
+
+        // only the index changes
+        Index index = repo->index();
+        index.addByPath("CMakeLists.txt");
+        index.write();
+        QVERIFY(verifyWatcher());
+        QVERIFY(watcher.status("CMakeLists.txt").isModifiedInIndex());
+        QVERIFY(!watcher.status("CMakeLists.txt").isModifiedInWorkdir());
+
+        // the unstaged change shows up again, though no file of the working directory changed
+        repo->reset(head, Repository::Mixed);
+        QVERIFY(verifyWatcher());
+        QVERIFY(!watcher.status("CMakeLists.txt").isModifiedInIndex());
+        QVERIFY(watcher.status("CMakeLists.txt").isModifiedInWorkdir());
+
+        // only the branch HEAD points to moves
+        repo->reset(parent, Repository::Soft);
+        QVERIFY(verifyWatcher());
+        QVERIFY(!watcher.paths().isEmpty());
+
+        // the index follows it, as after git reset --mixed HEAD~1
+        repo->reset(parent, Repository::Mixed);
+        QVERIFY(verifyWatcher());
+        QVERIFY(!watcher.paths().isEmpty());
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestRepository::testWorkdirWatcherUpdateFailure()
+{
+    initTestRepo();
+
+    try {
+        repo->open(testdir);
+        WorkdirWatcher watcher(*repo);
+        QSignalSpy failed(&watcher, SIGNAL(updateFailed(QString)));
+
+        QFile head(testdir + "/.git/HEAD");
+        QVERIFY(head.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        head.write("not a reference\n");
+        head.close();
+
+        // the slot reports the error instead of throwing into the event loop
+        watcher.update();
+        QCOMPARE(failed.count(), 1);
+        QVERIFY(!failed.at(0).at(0).toString().isEmpty());
+
+        EXPECT_THROW(watcher.updateStatus(), Exception);
+        QCOMPARE(failed.count(), 1);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestRepository::testStatusListSummary()
+{
+    initTestRepo();
+
+    try {
+        repo->open(testdir);
+
+        QFile modified(testdir + "/CMakeLists.txt");
+        QVERIFY(modified.open(QIODevice::Append));
+        modified.write("# changed in the working directory\n");
+        modified.close();
+        QVERIFY(QFile::remove(testdir + "/COPYING"));
+        QFile added(testdir + "/added.txt");
+        QVERIFY(added.open(QIODevice::WriteOnly));
+        added.close();
+
+        const StatusList list = repo->status(StatusOptions(StatusOptions::ShowIndexAndWorkdir, StatusOptions::IncludeUntracked));
+        QCOMPARE(list.entryCount(), size_t(3));
+        QCOMPARE(size_t(list.end() - list.begin()), list.entryCount());
+
+        QStringList paths;
+        for (const StatusEntry &entry : list) {
+            QVERIFY(qstrcmp(entry.rawOldPath(), entry.rawNewPath()) == 0);
+            paths << QString::fromUtf8(entry.rawNewPath());
+        }
+        paths.sort();
+        QCOMPARE(paths, QStringList() << "CMakeLists.txt" << "COPYING" << "added.txt");
+
+        const StatusList::Summary summary = list.summary();
+        QCOMPARE(summary.workdirModified, 1);
+        QCOMPARE(summary.workdirDeleted, 1);
+        QCOMPARE(summary.workdirNew, 1);
+        QCOMPARE(summary.indexNew + summary.indexModified + summary.indexDeleted, 0);
+
+        const StatusList filtered = list.filtered(QStringList() << "added.txt" << "COPY*");
+        QCOMPARE(filtered.entryCount(), size_t(2));
+        QStringList filteredPaths;
+        for (StatusList::const_iterator it = filtered.begin(); it != filtered.end(); ++it) {
+            filteredPaths << it->path();
+        }
+        filteredPaths.sort();
+        QCOMPARE(filteredPaths, QStringList() << "COPYING" << "added.txt");
+        QCOMPARE(filtered.summary().workdirDeleted, 1);
+        QCOMPARE(filtered.summary().workdirNew, 1);
+        QCOMPARE(filtered.summary().workdirModified, 0);
+        QCOMPARE(list.filtered(QStringList()).entryCount(), size_t(3));
+        QCOMPARE(list.filtered(QStringList() << "nothing/").entryCount(), size_t(0));
+        QCOMPARE(list.entryCount(), size_t(3));
+
+        QCOMPARE(StatusList().entryCount(), size_t(0));
+        QVERIFY(StatusList().begin() == StatusList().end());
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+static const int BenchmarkRefCount = 500;
+
+// the benchmarks are slow, they only run on request
+#define SKIP_UNLESS_BENCHMARKING() \
+    if (qEnvironmentVariableIsEmpty("LIBQGIT2_BENCHMARKS")) { \
+        SKIPTEST("set LIBQGIT2_BENCHMARKS to run the benchmarks"); \
+    }
+
+void TestRepository::benchmarkCreateRefs()
+{
+    SKIP_UNLESS_BENCHMARKING();
+    initTestRepo();
+
+    try {
+        repo->open(testdir);
+        const OId head = repo->head().target();
+
+        QBENCHMARK_ONCE {
+            for (int i = 0; i < BenchmarkRefCount; ++i) {
+                repo->createRef(QString("refs/bench/%1").arg(i), head, true, "benchmark");
+            }
+        }
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestRepository::benchmarkCreateRefsInTransaction()
+{
+    SKIP_UNLESS_BENCHMARKING();
+    initTestRepo();
+
+    try {
+        repo->open(testdir);
+        const OId head = repo->head().target();
+
+        QBENCHMARK_ONCE {
+            RefTransaction tx(*repo);
+            for (int i = 0; i < BenchmarkRefCount; ++i) {
+                const QString name = QString("refs/bench/%1").arg(i);
+                tx.lockRef(name);
+                tx.setTarget(name, head, "benchmark");
+            }
+            tx.commit();
+        }
+        QCOMPARE(repo->lookupRefOId(QString("refs/bench/%1").arg(BenchmarkRefCount - 1)), head);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
 QTEST_MAIN(TestRepository)
 
 #include "Repository.moc"
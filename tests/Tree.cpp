@@ -0,0 +1,273 @@
+/******************************************************************************
+* Permission to use, copy, modify, and distribute the software
+* and its documentation for any purpose and without fee is hereby
+* granted, provided that the above copyright notice appear in all
+* copies and that both that the copyright notice and this
+* permission notice and warranty disclaimer appear in supporting
+* documentation, and that the name of the author not be used in
+* advertising or publicity pertaining to distribution of the
+* software without specific, written prior permission.
+*
+* The author disclaim all warranties with regard to this
+* software, including all implied warranties of merchantability
+* and fitness.  In no event shall the author be liable for any
+* special, indirect or consequential damages or any damages
+* whatsoever resulting from loss of use, data or profits, whether
+* in an action of contract, negligence or other tortious action,
+* arising out of or in connection with the use or performance of
+* this software.
+*/
+
+#include "TestHelpers.h"
+#include "qgitrepository.h"
+#include "qgitcommit.h"
+#include "qgitblob.h"
+#include "qgittree.h"
+#include "qgittreebuilder.h"
+#include "qgittreeentry.h"
+
+using namespace LibQGit2;
+
+class TestTree : public TestBase
+{
+    Q_OBJECT
+
+private slots:
+    void testWalk();
+    void testEntryByPath();
+    void testEntryLifetime();
+    void testBlobAtPath();
+    void testTreeBuilder();
+    void testUpdateTree();
+};
+
+
+void TestTree::testWalk()
+{
+    Repository repo;
+    repo.open(ExistingRepository);
+
+    try {
+        const Tree tree = repo.lookupRevision("e3f21f35e5^{tree}").toTree();
+
+        QList<QByteArray> preOrder;
+        tree.walk(Tree::PreOrder, [&](const QByteArray &path, const TreeEntry &) {
+            preOrder << path;
+            return Tree::WalkContinue;
+        });
+        QVERIFY(preOrder.contains("src/blob.cpp"));
+        QVERIFY(preOrder.indexOf("src") < preOrder.indexOf("src/blob.cpp"));
+
+        QList<QByteArray> postOrder;
+        tree.walk(Tree::PostOrder, [&](const QByteArray &path, const TreeEntry &) {
+            postOrder << path;
+            return Tree::WalkContinue;
+        });
+        QCOMPARE(postOrder.size(), preOrder.size());
+        QVERIFY(postOrder.indexOf("src") > postOrder.indexOf("src/blob.cpp"));
+
+        QList<QByteArray> pruned;
+        tree.walk(Tree::PreOrder, [&](const QByteArray &path, const TreeEntry &entry) {
+            pruned << path;
+            return entry.type() == Object::TreeType ? Tree::WalkSkipSubtree : Tree::WalkContinue;
+        });
+        QCOMPARE(size_t(pruned.size()), tree.entryCount());
+        QVERIFY(pruned.contains("src"));
+        QVERIFY(!pruned.contains("src/blob.cpp"));
+
+        int visited = 0;
+        tree.walk(Tree::PreOrder, [&](const QByteArray &, const TreeEntry &) {
+            return ++visited == 2 ? Tree::WalkStop : Tree::WalkContinue;
+        });
+        QCOMPARE(visited, 2);
+
+        EXPECT_THROW(tree.walk(Tree::PreOrder, [](const QByteArray &, const TreeEntry &) -> Tree::WalkResult {
+            throw Exception("stop");
+        }), Exception);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestTree::testEntryByPath()
+{
+    Repository repo;
+    repo.open(ExistingRepository);
+
+    try {
+        TreeEntry entry(0);
+        {
+            const Tree tree = repo.lookupRevision("e3f21f35e5^{tree}").toTree();
+            entry = tree.entryByPath("src/blob.cpp");
+            QVERIFY(tree.entryByPath("src/missing.cpp").isNull());
+            QVERIFY(tree.entryByPath("CMakeLists.txt/blob.cpp").isNull());
+
+            const QList<TreeEntry> entries = tree.entriesByPaths(QStringList()
+                << "src/blob.cpp" << "CMakeLists.txt" << "missing/blob.cpp" << "src");
+            QCOMPARE(entries.size(), 4);
+            QCOMPARE(entries[0].oid(), entry.oid());
+            QCOMPARE(entries[1].name(), QString("CMakeLists.txt"));
+            QVERIFY(entries[2].isNull());
+            QCOMPARE(entries[3].type(), Object::TreeType);
+        }
+
+        // the entry outlives the tree it was found in
+        QCOMPARE(entry.name(), QString("blob.cpp"));
+        QCOMPARE(entry.type(), Object::BlobType);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestTree::testEntryLifetime()
+{
+    Repository repo;
+    repo.open(ExistingRepository);
+
+    try {
+        TreeEntry entry(0);
+        QVector<TreeEntryInfo> infos;
+        TreeEntryInfo otherInfo;
+        {
+            const Tree tree = repo.lookupRevision("e3f21f35e5^{tree}").toTree();
+            entry = tree.entryByName("CMakeLists.txt");
+            infos = tree.entryInfos();
+            QCOMPARE(size_t(infos.size()), tree.entryCount());
+
+            const Tree other = repo.lookupRevision("4146952e67^{tree}").toTree();
+            otherInfo = TreeEntryInfo(other.entryByName("CMakeLists.txt"));
+        }
+
+        // the entry keeps its tree alive
+        QCOMPARE(entry.name(), QString("CMakeLists.txt"));
+
+        const TreeEntryInfo *info = 0;
+        foreach (const TreeEntryInfo &i, infos) {
+            if (i.name() == "CMakeLists.txt") {
+                info = &i;
+            }
+        }
+        QVERIFY(info);
+        QCOMPARE(info->oid(), entry.oid());
+        QCOMPARE(info->attributes(), entry.attributes());
+        QCOMPARE(info->type(), Object::BlobType);
+
+        // equal names are interned
+        QVERIFY(info->rawName().constData() == otherInfo.rawName().constData());
+
+        QVERIFY(TreeEntryInfo().isNull());
+        QVERIFY(TreeEntryInfo(TreeEntry(0)).isNull());
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestTree::testBlobAtPath()
+{
+    Repository repo;
+    repo.open(ExistingRepository);
+
+    try {
+        const Commit commit = repo.lookupRevision("e3f21f35e5").toCommit();
+        const OId expected = commit.tree().entryByPath("src/blob.cpp").oid();
+
+        QCOMPARE(commit.blobAtPath("src/blob.cpp").oid(), expected);
+        QVERIFY(commit.blobAtPath("src/missing.cpp").isNull());
+        QVERIFY(commit.blobAtPath("src").isNull());
+
+        QCOMPARE(repo.treePathCacheHits(), 0);
+        repo.setTreePathCacheSize(16);
+        QCOMPARE(commit.blobAtPath("src/blob.cpp").oid(), expected);
+        QCOMPARE(repo.treePathCacheHits(), 0);
+        QCOMPARE(commit.blobAtPath("src/blob.cpp").oid(), expected);
+        QCOMPARE(repo.treePathCacheHits(), 1);
+
+        // the cache is shared with other handles on the same repository
+        Repository other;
+        other.open(ExistingRepository);
+        QCOMPARE(other.lookupCommit(commit.oid()).blobAtPath("src/blob.cpp").oid(), expected);
+        QCOMPARE(repo.treePathCacheHits(), 2);
+        QCOMPARE(other.treePathCacheHits(), 2);
+
+        // missing paths are not cached
+        QVERIFY(commit.blobAtPath("src/missing.cpp").isNull());
+        QCOMPARE(repo.treePathCacheHits(), 2);
+
+        repo.setTreePathCacheSize(0);
+        QCOMPARE(commit.blobAtPath("src/blob.cpp").oid(), expected);
+        QCOMPARE(repo.treePathCacheHits(), 0);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestTree::testTreeBuilder()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+
+        const Tree base = repo.lookupRevision("e3f21f35e5^{tree}").toTree();
+        const OId blob = repo.createBlobFromBuffer("built without an index\n");
+
+        TreeBuilder builder(repo, base);
+        QCOMPARE(builder.entryCount(), base.entryCount());
+        builder.insert("NEW", blob);
+        builder.remove("CMakeLists.txt");
+        EXPECT_THROW(builder.remove("CMakeLists.txt"), Exception);
+        QCOMPARE(builder.entryByName("NEW").oid(), blob);
+        QVERIFY(builder.entryByName("CMakeLists.txt").isNull());
+
+        const Tree tree = repo.lookupTree(builder.write());
+        QCOMPARE(tree.entryCount(), base.entryCount());
+        QCOMPARE(tree.entryByName("NEW").oid(), blob);
+        QCOMPARE(tree.entryByName("NEW").attributes(), unsigned(TreeBuilder::BlobMode));
+        QCOMPARE(tree.entryByName("src").oid(), base.entryByName("src").oid());
+
+        builder.clear();
+        QCOMPARE(builder.entryCount(), size_t(0));
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+void TestTree::testUpdateTree()
+{
+    initTestRepo();
+
+    try {
+        Repository repo;
+        repo.open(testdir);
+
+        const Tree base = repo.lookupRevision("e3f21f35e5^{tree}").toTree();
+        const OId blob = repo.createBlobFromBuffer("updated without an index\n");
+
+        QMap<QString, OId> changes;
+        changes["src/blob.cpp"] = blob;
+        changes["new/dir/file.txt"] = blob;
+        changes["CMakeLists.txt"] = OId();
+        changes["missing.txt"] = OId();
+        const Tree tree = repo.lookupTree(repo.updateTree(base, changes));
+
+        QCOMPARE(tree.entryByPath("src/blob.cpp").oid(), blob);
+        QCOMPARE(tree.entryByPath("new/dir/file.txt").oid(), blob);
+        QVERIFY(tree.entryByName("CMakeLists.txt").isNull());
+        QCOMPARE(tree.entryCount(), base.entryCount());
+
+        // directories left empty disappear
+        changes.clear();
+        changes["new/dir/file.txt"] = OId();
+        const Tree reverted = repo.lookupTree(repo.updateTree(tree, changes));
+        QVERIFY(reverted.entryByName("new").isNull());
+
+        EXPECT_THROW(repo.updateTree(base, QMap<QString, OId>{{"/absolute", blob}}), Exception);
+    } catch (const Exception& ex) {
+        QFAIL(ex.what());
+    }
+}
+
+QTEST_MAIN(TestTree);
+
+#include "Tree.moc"